@@ -0,0 +1,138 @@
+module CArrayOps;
+
+# Sums, minimum and maximum, dot products, scaling, elementwise addition
+# and comparison with a threshold for CArrays of numbers, each done by
+# vectorized C code in carrayops.c in a single native call.  A Perl 6
+# loop over a CArray goes through an at_pos Proxy for every element.
+#
+#   use lib 'examples';
+#   use CArrayOps;
+#   my $values = nativecast(CArray[num64], some_c_function());
+#   say carray-sum($values, $count);
+#
+# The count of elements is always given, as a CArray from C does not
+# know its size; the arrays must have at least that many.  The element
+# type may be num64 (or num), num32, int32, int64 (or int), or long,
+# which is one of the two as in C: 4 bytes on Windows and on 32 bit
+# machines, 8 elsewhere.  Build carrayops.c as described at the top of it,
+# and run with LD_LIBRARY_PATH set to where carrayops.so is.
+
+use NativeCall;
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub carrayops_above_int32(CArray, long, Int, CArray) returns long is native('carrayops') { * }
+sub carrayops_above_int64(CArray, long, Int, CArray) returns long is native('carrayops') { * }
+sub carrayops_above_num32(CArray, long, num64, CArray) returns long is native('carrayops') { * }
+sub carrayops_above_num64(CArray, long, num64, CArray) returns long is native('carrayops') { * }
+sub carrayops_add_int32(CArray, CArray, CArray, long) is native('carrayops') { * }
+sub carrayops_add_int64(CArray, CArray, CArray, long) is native('carrayops') { * }
+sub carrayops_add_num32(CArray, CArray, CArray, long) is native('carrayops') { * }
+sub carrayops_add_num64(CArray, CArray, CArray, long) is native('carrayops') { * }
+sub carrayops_dot_int32(CArray, CArray, long) returns Int is native('carrayops') { * }
+sub carrayops_dot_int64(CArray, CArray, long) returns Int is native('carrayops') { * }
+sub carrayops_dot_num32(CArray, CArray, long) returns num64 is native('carrayops') { * }
+sub carrayops_dot_num64(CArray, CArray, long) returns num64 is native('carrayops') { * }
+sub carrayops_max_int32(CArray, long) returns int32 is native('carrayops') { * }
+sub carrayops_max_int64(CArray, long) returns Int is native('carrayops') { * }
+sub carrayops_max_num32(CArray, long) returns num32 is native('carrayops') { * }
+sub carrayops_max_num64(CArray, long) returns num64 is native('carrayops') { * }
+sub carrayops_min_int32(CArray, long) returns int32 is native('carrayops') { * }
+sub carrayops_min_int64(CArray, long) returns Int is native('carrayops') { * }
+sub carrayops_min_num32(CArray, long) returns num32 is native('carrayops') { * }
+sub carrayops_min_num64(CArray, long) returns num64 is native('carrayops') { * }
+sub carrayops_scale_int32(CArray, long, Int) is native('carrayops') { * }
+sub carrayops_scale_int64(CArray, long, Int) is native('carrayops') { * }
+sub carrayops_scale_num32(CArray, long, num64) is native('carrayops') { * }
+sub carrayops_scale_num64(CArray, long, num64) is native('carrayops') { * }
+sub carrayops_sum_int32(CArray, long) returns Int is native('carrayops') { * }
+sub carrayops_sum_int64(CArray, long) returns Int is native('carrayops') { * }
+sub carrayops_sum_num32(CArray, long) returns num64 is native('carrayops') { * }
+sub carrayops_sum_num64(CArray, long) returns num64 is native('carrayops') { * }
+
+# ------------------------------ dispatch -------------------------------
+
+# The carrayops.c functions for each element type, and how to convert
+# the factors and thresholds that they take
+my %element-kernels =
+    num   => 'num64', num64 => 'num64', num32 => 'num32',
+    int32 => 'int32', int64 => 'int64', int => 'int64',
+    long  => native-size(long) == 4 ?? 'int32' !! 'int64';
+
+my %kernels =
+    num64 => { :sum(&carrayops_sum_num64), :min(&carrayops_min_num64), :max(&carrayops_max_num64),
+               :dot(&carrayops_dot_num64), :scale(&carrayops_scale_num64), :add(&carrayops_add_num64),
+               :above(&carrayops_above_num64), :convert(*.Num) },
+    num32 => { :sum(&carrayops_sum_num32), :min(&carrayops_min_num32), :max(&carrayops_max_num32),
+               :dot(&carrayops_dot_num32), :scale(&carrayops_scale_num32), :add(&carrayops_add_num32),
+               :above(&carrayops_above_num32), :convert(*.Num) },
+    int32 => { :sum(&carrayops_sum_int32), :min(&carrayops_min_int32), :max(&carrayops_max_int32),
+               :dot(&carrayops_dot_int32), :scale(&carrayops_scale_int32), :add(&carrayops_add_int32),
+               :above(&carrayops_above_int32), :convert(*.Int) },
+    int64 => { :sum(&carrayops_sum_int64), :min(&carrayops_min_int64), :max(&carrayops_max_int64),
+               :dot(&carrayops_dot_int64), :scale(&carrayops_scale_int64), :add(&carrayops_add_int64),
+               :above(&carrayops_above_int64), :convert(*.Int) };
+
+sub kernels(CArray $array, *@others) {
+    my $type = $array.of.^name;
+    die "CArrayOps cannot work on CArray[$type]" unless %element-kernels{$type}:exists;
+    for @others -> $other {
+        die "CArrayOps needs arrays of one type, not CArray[$type] and CArray[{$other.of.^name}]"
+            unless (%element-kernels{$other.of.^name} // '') eq %element-kernels{$type};
+    }
+    %kernels{%element-kernels{$type}};
+}
+
+# ------------------------------ operations -----------------------------
+
+# The sum of the first $n elements, a Num for num arrays and an Int for
+# int arrays
+sub carray-sum(CArray $a, Int $n) is export {
+    kernels($a)<sum>($a, $n);
+}
+
+# The smallest and largest of the first $n elements, 0 if $n is 0
+sub carray-min(CArray $a, Int $n) is export {
+    kernels($a)<min>($a, $n);
+}
+
+sub carray-max(CArray $a, Int $n) is export {
+    kernels($a)<max>($a, $n);
+}
+
+# The sum of $a[$i] * $b[$i] for the first $n elements
+sub carray-dot(CArray $a, CArray $b, Int $n) is export {
+    kernels($a, $b)<dot>($a, $b, $n);
+}
+
+# Multiplies the first $n elements by $factor, in place.  Int arrays
+# take an Int factor.
+sub carray-scale(CArray $a, Int $n, $factor) is export {
+    my %k = kernels($a);
+    %k<scale>($a, $n, %k<convert>($factor));
+    $a;
+}
+
+# Adds the first $n elements of $b to those of $a, into $out, which is a
+# new array unless one is passed, and may be $a or $b
+sub carray-add(CArray $a, CArray $b, Int $n, CArray :$out is copy) is export {
+    unless $out.defined {
+        $out = $a.WHAT.new;
+        $out[$n - 1] = $a[0] if $n;  # makes room for $n elements
+    }
+    kernels($a, $b, $out)<add>($a, $b, $out, $n);
+    $out;
+}
+
+# How many of the first $n elements are above $threshold.  With :mask,
+# returns a CArray[int8] of 1 for those and 0 for the others as well.
+sub carray-above(CArray $a, Int $n, $threshold, :$mask) is export {
+    my %k = kernels($a);
+    my $flags = CArray[int8];
+    if $mask {
+        $flags = CArray[int8].new;
+        $flags[$n - 1] = 0 if $n;
+    }
+    my $count = %k<above>($a, $n, %k<convert>($threshold), $flags);
+    $mask ?? ($count, $flags) !! $count;
+}
@@ -0,0 +1,93 @@
+module Chain;
+
+# Walks C linked lists and NULL terminated arrays of pointers with the
+# C code in chain.c, many nodes per native call, instead of one field
+# access and one wrapper per hop.
+#
+#   use lib 'examples';
+#   use Chain;
+#   class Entry is repr('CStruct') {
+#       has Str   $.name;
+#       has Entry $.next;
+#   }
+#   .name.say for chain(Entry, first_entry(), 'next');
+#
+# The head of a list may be a CStruct, a CPointer to one, or an Int
+# address.  Build chain.c as described at the top of it, and run with
+# LD_LIBRARY_PATH set to where chain.so is.
+
+use NativeCall;
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub chain_collect(OpaquePointer, long, long, CArray[int64], long) returns long is native('chain') { * }
+sub chain_null_terminated_length(CArray, long, long) returns long is native('chain') { * }
+
+# ------------------------------- helpers -------------------------------
+
+sub address($head) {
+    $head ~~ Int ?? $head !! $head.defined ?? nativecast(OpaquePointer, $head).Int !! 0;
+}
+
+# ------------------------------ iteration ------------------------------
+
+# The nodes of the list that starts at $head and goes on through its
+# $next field, as a lazy Seq of $type objects.  The addresses of $batch
+# nodes are read in each native call, so a list must not be changed
+# while it is read.  A type that does CachedWrappers gets its cached
+# wrappers.
+sub chain(Mu $type, $head, Str $next, Int :$batch = 64) is export {
+    my $offset = field-offset($type, $next);
+    my $addresses = CArray[int64].allocate($batch + 1);
+    my $node = address($head);
+    my $cached = $type ~~ CachedWrappers;
+    gather while $node {
+        my $count = chain_collect(OpaquePointer.new($node), $offset, $batch, $addresses, 0);
+        $node = $addresses[$count];
+        for ^$count -> $i {
+            my $wrapper = nativecast($type, OpaquePointer.new($addresses[$i]));
+            take $cached ?? cached-wrapper($wrapper) !! $wrapper;
+        }
+    }
+}
+
+# The addresses of all the nodes of the list, as a CArray[int64] with
+# one element for each.  Lists of up to $size nodes take one native
+# call, and longer ones one more each time the size doubles.
+sub chain-addresses(Mu $type, $head, Str $next, Int :$size = 1024) is export {
+    my $offset = field-offset($type, $next);
+    my $addresses = CArray[int64].allocate($size + 1);
+    my $count = 0;
+    my $node = address($head);
+    loop {
+        $count += chain_collect(OpaquePointer.new($node), $offset,
+            $addresses.elems - $count - 1, $addresses, $count);
+        $node = $addresses[$count];
+        last unless $node;
+        $addresses.reserve(2 * $addresses.elems);
+    }
+    $addresses.shrink($count);
+}
+
+# The number of elements before the first NULL in an array of strings,
+# structs, pointers or arrays, looking at no more than $max
+sub null-terminated-length(CArray $array, Int :$max = 2 ** 62) is export {
+    my Mu $type := $array.of;
+    die "Can only look for NULL in arrays of pointers, not in CArray[{$type.^name}]"
+        unless $type === Str || $type.REPR eq 'CStruct' | 'CPointer' | 'CArray';
+    chain_null_terminated_length($array, 0, $max);
+}
+
+# The elements before the first NULL, as a lazy Seq.  The array is
+# looked at $batch elements ahead of what is read, so that a long or
+# unterminated one is not walked to the end before the first element.
+sub null-terminated(CArray $array, Int :$max = 2 ** 62, Int :$batch = 64) is export {
+    null-terminated-length($array, max => 0);  # checks the type
+    my $from = 0;
+    gather while $from < $max {
+        my $count = chain_null_terminated_length($array, $from, min($batch, $max - $from));
+        take $array[$_] for $from ..^ $from + $count;
+        last if $count < $batch;
+        $from += $count;
+    }
+}
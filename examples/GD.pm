@@ -0,0 +1,144 @@
+module GD;
+
+# Draws with the GD graphics library in batches, and encodes images to
+# memory instead of to files.
+#
+# Drawing a line per native call costs a crossing for each.  A
+# GDCommands packs lines, pixels and rectangles into a CArray of ints,
+# which gdbatch.c draws in one call.  The PNG and JPEG encoders to
+# memory give a GDImageData, which points at the bytes that gd
+# allocated without copying them, and gives them back to gd with gdFree.
+#
+#   use lib 'examples';
+#   use GD;
+#   my $im = gdImageCreate(64, 64);
+#   my $black = gdImageColorAllocate($im, 0, 0, 0);
+#   my $white = gdImageColorAllocate($im, 255, 255, 255);
+#   my $commands = GDCommands.new;
+#   $commands.line(0, $_, 63, 63 - $_, $white) for ^64;
+#   gd-draw($im, $commands);
+#   my $png = gd-png-data($im);
+#   $socket.write($png.Blob);
+#   $png.free;
+#   gdImageDestroy($im);
+#
+# Build gdbatch.c as described at the top of it, and run with
+# LD_LIBRARY_PATH set to where gdbatch.so is.
+
+use NativeCall;
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub gdbatch_draw(OpaquePointer, CArray[int32], long) returns long is native('gdbatch') { * }
+sub gdFree(OpaquePointer) is native('libgd') { * }
+sub gdImageColorAllocate(OpaquePointer, int32, int32, int32) returns int32 is native('libgd') is export { * }
+sub gdImageCreate(int32, int32) returns OpaquePointer is native('libgd') is export { * }
+sub gdImageCreateTrueColor(int32, int32) returns OpaquePointer is native('libgd') is export { * }
+sub gdImageDestroy(OpaquePointer) is native('libgd') is export { * }
+sub gdImageJpegPtr(OpaquePointer, CArray[int32], int32) returns OpaquePointer is native('libgd') { * }
+sub gdImagePngPtr(OpaquePointer, CArray[int32]) returns OpaquePointer is native('libgd') { * }
+sub memcpy(buf8, OpaquePointer, long) returns OpaquePointer is native(Str) { * }
+
+# ------------------------------ encoding -------------------------------
+
+# The bytes of an encoded image, in memory that gd allocated
+class GDImageData is export {
+    has OpaquePointer $.pointer;
+    has Int $.bytes;
+
+    # The bytes as a CArray[int8], without copying them.  It is only
+    # good until the data is freed.
+    method carray() {
+        die "GDImageData already freed" unless $!pointer.defined;
+        nativecast(CArray[int8], $!pointer);
+    }
+
+    # A copy of the bytes, made with one memcpy
+    method Blob() {
+        die "GDImageData already freed" unless $!pointer.defined;
+        my $blob = buf8.new;
+        if $!bytes {
+            $blob[$!bytes - 1] = 0;  # makes room for all of them at once
+            memcpy($blob, $!pointer, $!bytes);
+        }
+        $blob;
+    }
+
+    # Gives the memory back to gd
+    method free() {
+        gdFree($!pointer) if $!pointer.defined;
+        $!pointer = OpaquePointer;
+    }
+
+    submethod DESTROY() {
+        self.free;
+    }
+}
+
+sub image-data(OpaquePointer $pointer, CArray $size, Str $encoder) {
+    die "$encoder failed" unless $pointer.defined;
+    GDImageData.new(:$pointer, bytes => $size[0]);
+}
+
+# The image encoded as PNG
+sub gd-png-data(OpaquePointer $im) is export {
+    my $size = CArray[int32].allocate(1);
+    image-data(gdImagePngPtr($im, $size), $size, 'gdImagePngPtr');
+}
+
+# The image encoded as JPEG, with a quality from 0 to 95, or -1 for
+# gd's default
+sub gd-jpeg-data(OpaquePointer $im, Int $quality = -1) is export {
+    my $size = CArray[int32].allocate(1);
+    image-data(gdImageJpegPtr($im, $size, $quality), $size, 'gdImageJpegPtr');
+}
+
+# ------------------------------- drawing -------------------------------
+
+# Drawing commands for gd-draw, packed as gdbatch.c wants them.  The
+# methods return the GDCommands, so that they can be chained.  clear
+# empties it, keeping its memory for the next batch.
+class GDCommands is export {
+    my constant WIDTH = 6;
+    has $.ints = CArray[int32].allocate(WIDTH * 256);
+    has Int $.elems = 0;
+
+    method !add(Int $op, Int $x1, Int $y1, Int $x2, Int $y2, Int $colour) {
+        my $at = WIDTH * $!elems;
+        $!ints.reserve(2 * $!ints.elems) if $at + WIDTH > $!ints.elems;
+        $!ints[$at]     = $op;
+        $!ints[$at + 1] = $x1;
+        $!ints[$at + 2] = $y1;
+        $!ints[$at + 3] = $x2;
+        $!ints[$at + 4] = $y2;
+        $!ints[$at + 5] = $colour;
+        $!elems++;
+        self;
+    }
+
+    method pixel($x, $y, $colour) {
+        self!add(0, $x, $y, 0, 0, $colour);
+    }
+
+    method line($x1, $y1, $x2, $y2, $colour) {
+        self!add(1, $x1, $y1, $x2, $y2, $colour);
+    }
+
+    method rectangle($x1, $y1, $x2, $y2, $colour) {
+        self!add(2, $x1, $y1, $x2, $y2, $colour);
+    }
+
+    method filled-rectangle($x1, $y1, $x2, $y2, $colour) {
+        self!add(3, $x1, $y1, $x2, $y2, $colour);
+    }
+
+    method clear() {
+        $!elems = 0;
+        self;
+    }
+}
+
+# Draws all the commands on the image in one native call
+sub gd-draw(OpaquePointer $im, GDCommands $commands) is export {
+    gdbatch_draw($im, $commands.ints, $commands.elems);
+}
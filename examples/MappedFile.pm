@@ -0,0 +1,120 @@
+class MappedFile;
+
+# A file mapped into memory with mmap, to read and write as a CArray
+# and to pass to C as one, without reading it into Perl or copying it.
+#
+#   use lib 'examples';
+#   use MappedFile;
+#   my $file = MappedFile.new('samples.bin');
+#   my $samples = $file.carray(num64);
+#   say carray-sum($samples, $file.elems(num64));  # from CArrayOps.pm
+#   $file.unmap;
+#
+# A file is mapped read only unless it is opened with :rw, and then
+# stores into the CArray go to the file; :size(N) makes it N bytes long
+# first, creating it if need be.  sync writes the changes to the file
+# now, rather than when the system gets to it.  The CArray and pointer
+# must not be used after unmap, which the object does on its own when
+# it is collected if it wasn't done before.
+#
+# The flags below are the same on Linux, macOS and the BSDs but for
+# MS_SYNC, which is looked up by $*KERNEL.name; sync dies on other
+# systems.  On Linux they are those of x86 and ARM, not of Alpha, MIPS
+# or SPARC.  A file that :size makes is created from Perl, which spares
+# O_CREAT, whose value differs between them.
+
+use NativeCall;
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub file_close(int32) returns int32 is native(Str) is symbol('close') { * }
+sub file_open(Str, int32, int32) returns int32 is native(Str) is symbol('open') { * }
+sub ftruncate(int32, long) returns int32 is native(Str) { * }
+sub lseek(int32, long, int32) returns long is native(Str) { * }
+sub memcpy(buf8, OpaquePointer, long) returns OpaquePointer is native(Str) { * }
+sub mmap(OpaquePointer, long, int32, int32, int32, long) returns OpaquePointer is native(Str) { * }
+sub msync(OpaquePointer, long, int32) returns int32 is native(Str) { * }
+sub munmap(OpaquePointer, long) returns int32 is native(Str) { * }
+
+constant O_RDONLY   = 0;
+constant O_RDWR     = 2;
+constant PROT_READ  = 1;
+constant PROT_WRITE = 2;
+constant MAP_SHARED = 1;
+constant SEEK_END   = 2;
+
+# MS_SYNC from the sys/mman.h of each system
+my %ms-sync = linux => 4, darwin => 0x10, freebsd => 0, netbsd => 4, openbsd => 2;
+
+has OpaquePointer $.pointer;
+has Int $.bytes;
+has Bool $.rw;
+
+method new(Str $path, Bool :$rw = False, Int :$size) {
+    if $size.defined {
+        die "Can only set the size of a file opened with :rw" unless $rw;
+        open($path, :w).close unless $path.IO.e;
+    }
+    my $fd = file_open($path, $rw ?? O_RDWR !! O_RDONLY, 0);
+    die "Cannot open $path" if $fd < 0;
+    LEAVE file_close($fd);
+    if $size.defined {
+        die "Cannot make $path $size bytes long" if ftruncate($fd, $size) != 0;
+    }
+    my $bytes = lseek($fd, 0, SEEK_END);
+    die "Cannot map $path, which is empty" unless $bytes > 0;
+    my $pointer = mmap(OpaquePointer, $bytes, PROT_READ +| ($rw ?? PROT_WRITE !! 0), MAP_SHARED, $fd, 0);
+    die "Cannot map $path" if !$pointer.defined || $pointer.Int == -1;  # MAP_FAILED
+    self.bless(:$pointer, :$bytes, :$rw);
+}
+
+submethod BUILD(:$!pointer, :$!bytes, :$!rw) { }
+
+method !mapped() {
+    die "MappedFile already unmapped" unless $!pointer.defined;
+}
+
+# The file as a CArray of $type, such as num64 or int32.  Stores into
+# it change the file, and would crash if it is mapped read only.
+method carray(Mu $type) {
+    self!mapped;
+    die "Can only view a file as a CArray of native numbers, not of {$type.^name}"
+        unless native-size($type).defined;
+    nativecast(CArray[$type], $!pointer);
+}
+
+# How many elements of $type the file holds
+method elems(Mu $type) {
+    $!bytes div native-size($type);
+}
+
+# A copy of $bytes bytes from $offset on, in a Blob, made with one memcpy
+method Blob(Int $offset = 0, Int $bytes = $!bytes - $offset) {
+    self!mapped;
+    die "$bytes bytes from $offset are not all in the file"
+        if $offset < 0 || $bytes < 0 || $offset + $bytes > $!bytes;
+    my $blob = buf8.new;
+    if $bytes {
+        $blob[$bytes - 1] = 0;  # makes room for all of them at once
+        memcpy($blob, OpaquePointer.new($!pointer.Int + $offset), $bytes);
+    }
+    $blob;
+}
+
+# Writes the changes to the file, and returns once they are written
+method sync() {
+    self!mapped;
+    my $ms-sync = %ms-sync{$*KERNEL.name}
+        // die "Don't know MS_SYNC on {$*KERNEL.name}";
+    die "Cannot sync the file" if msync($!pointer, $!bytes, $ms-sync) != 0;
+    self;
+}
+
+method unmap() {
+    munmap($!pointer, $!bytes) if $!pointer.defined;
+    $!pointer = OpaquePointer;
+}
+
+submethod DESTROY() {
+    self.unmap;
+}
@@ -0,0 +1,222 @@
+module MysqlStmt;
+
+# Prepared statements for MySQL, with parameters bound in binary.
+# mysqlclient.p6 puts values into the text of each statement with
+# mysql_query, so the server parses every row again, and every number
+# goes to text and back.  A MysqlStatement is parsed once by
+# mysql_stmt_prepare, and its parameters are bound to buffers with an
+# array of MYSQL_BIND structs, so each execute only writes the values
+# into the buffers.
+#
+#   use lib 'examples';
+#   use MysqlStmt;
+#   my $insert = MysqlStatement.new($client, 'INSERT INTO t VALUES (?, ?, ?)',
+#       MYSQL_TYPE_LONGLONG, MYSQL_TYPE_STRING, MYSQL_TYPE_DOUBLE);
+#   $insert.execute($_, "row $_", $_ / 3e0) for ^100000;
+#   $insert.close;
+#
+# A type object sends NULL.  The MYSQL_BIND layout below is written out
+# by hand, and is only right where long and pointers are 8 bytes (LP64:
+# 64 bit Linux, the BSDs and macOS, not Windows) with the mysql.h of
+# MySQL 5.5 to 8.0 or of MariaDB Connector/C.  Elsewhere compare it with
+# sizeof(MYSQL_BIND) and offsetof in a C program against your headers.
+#
+# The library is libmysqlclient unless the MYSQLSTMT_LIBMYSQLCLIENT
+# environment variable names another one when this module is compiled,
+# which the tests and bench/02-prepared.pl6 use to run against
+# t/12-prepared.c.
+
+use NativeCall;
+
+constant LIBMYSQLCLIENT = %*ENV<MYSQLSTMT_LIBMYSQLCLIENT> // 'libmysqlclient';
+
+# from mysql.h (enum_field_types), the types that can be bound here
+constant MYSQL_TYPE_LONG     is export = 3;
+constant MYSQL_TYPE_DOUBLE   is export = 5;
+constant MYSQL_TYPE_LONGLONG is export = 8;
+constant MYSQL_TYPE_STRING   is export = 254;
+
+# sizeof(MYSQL_BIND) with the headers and machines above
+constant MYSQL_BIND_SIZE = 112;
+
+# The fields of MYSQL_BIND, in order.  Only the first three and
+# buffer_type and buffer_length matter for parameters.
+class MysqlBind is repr('CStruct') is export {
+    has OpaquePointer $.length;   # unsigned long *
+    has OpaquePointer $.is_null;  # my_bool *
+    has OpaquePointer $.buffer;
+    has OpaquePointer $.error;
+    has OpaquePointer $.row_ptr;
+    has OpaquePointer $.store_param_func;
+    has OpaquePointer $.fetch_result;
+    has OpaquePointer $.skip_result;
+    has long          $.buffer_length;
+    has long          $.offset;
+    has long          $.length_value;
+    has int32         $.param_number;
+    has int32         $.pack_length;
+    has int32         $.buffer_type;
+    has int8          $.error_value;
+    has int8          $.is_unsigned;
+    has int8          $.long_data_used;
+    has int8          $.is_null_value;
+    has OpaquePointer $.extension;
+
+    # Work around struct members not being containerized yet.
+    method init(OpaquePointer $length, OpaquePointer $is_null, Int $buffer_type) {
+        $!length      := $length;
+        $!is_null     := $is_null;
+        $!buffer_type = $buffer_type;
+    }
+
+    method point-at(OpaquePointer $buffer) {
+        $!buffer := $buffer;
+    }
+}
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub mysql_error( OpaquePointer $mysql_client)
+    returns Str
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub mysql_stmt_bind_param( OpaquePointer $stmt, OpaquePointer $bind )
+    returns int8
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub mysql_stmt_close( OpaquePointer $stmt )
+    returns int8
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub mysql_stmt_error( OpaquePointer $stmt )
+    returns Str
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub mysql_stmt_execute( OpaquePointer $stmt )
+    returns int32
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub mysql_stmt_init( OpaquePointer $mysql_client )
+    returns OpaquePointer
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub mysql_stmt_param_count( OpaquePointer $stmt )
+    returns long
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub mysql_stmt_prepare( OpaquePointer $stmt, Str $query, long $length )
+    returns int32
+    is native(LIBMYSQLCLIENT)
+    { ... }
+
+sub strlen( OpaquePointer $string )
+    returns long
+    is native(Str)
+    { ... }
+
+# ------------------------ prepared statements --------------------------
+
+# A statement prepared on a connection.  Numbers are written straight
+# into buffers that stay bound from one execute to the next; strings
+# need the binds to be passed again for each row, since the client
+# library keeps a copy of them.
+class MysqlStatement is export {
+    has $.stmt;
+    has @.types;
+    has $!memory;   # the MYSQL_BIND array, as words
+    has $!array;    # and where it is
+    has @!binds;    # a MysqlBind view of each element
+    has @!buffers;  # the value of each number parameter
+    has @!lengths;  # CArray[long] of each string length
+    has @!nulls;    # CArray[int8] of each NULL flag
+    has @!strings;  # CArray[Str] that own the string parameters
+    has $!strings-bound;
+
+    method new(OpaquePointer $mysql, Str $sql, *@types) {
+        my $stmt = mysql_stmt_init($mysql);
+        die "mysql_stmt_init failed: {mysql_error($mysql)}" unless $stmt.defined;
+        my $failure = mysql_stmt_prepare($stmt, $sql, $sql.encode('utf8').bytes)
+            ?? mysql_stmt_error($stmt)
+            !! mysql_stmt_param_count($stmt) != @types
+            ?? "{+@types} types for {mysql_stmt_param_count($stmt)} parameters"
+            !! Str;
+        if $failure.defined {
+            mysql_stmt_close($stmt);
+            die "mysql_stmt_prepare failed: $failure";
+        }
+        self.bless(:$stmt, :@types);
+    }
+
+    submethod BUILD(:$!stmt, :@!types) {
+        $!memory = CArray[int64].new;
+        $!memory[$_] = 0 for ^(@!types * MYSQL_BIND_SIZE div 8);
+        $!array = nativecast(OpaquePointer, $!memory);
+        for @!types.kv -> $i, $type {
+            my $bind = nativecast(MysqlBind, OpaquePointer.new($!array.Int + $i * MYSQL_BIND_SIZE));
+            my $length = CArray[long].new;
+            my $null   = CArray[int8].new;
+            $length[0] = 0;
+            $null[0]   = 0;
+            $bind.init(nativecast(OpaquePointer, $length), nativecast(OpaquePointer, $null), $type);
+            my $buffer;
+            given $type {
+                when MYSQL_TYPE_LONG     { $buffer = CArray[int32].new }
+                when MYSQL_TYPE_LONGLONG { $buffer = CArray[int64].new }
+                when MYSQL_TYPE_DOUBLE   { $buffer = CArray[num64].new }
+                default                  { $!strings-bound = True }
+            }
+            if $buffer.defined {
+                $buffer[0] = 0;
+                $bind.point-at(nativecast(OpaquePointer, $buffer));
+            }
+            @!binds[$i]   = $bind;
+            @!buffers[$i] = $buffer;
+            @!lengths[$i] = $length;
+            @!nulls[$i]   = $null;
+        }
+        self!bind;
+    }
+
+    method !bind() {
+        die "mysql_stmt_bind_param failed: {mysql_stmt_error($!stmt)}"
+            if @!types && mysql_stmt_bind_param($!stmt, $!array);
+    }
+
+    # Runs the statement with one value for each parameter
+    method execute(*@params) {
+        die "{+@params} values for {+@!types} parameters" unless @params == @!types;
+        @!strings = ();
+        for @params.kv -> $i, $value {
+            @!nulls[$i][0] = $value.defined ?? 0 !! 1;
+            next unless $value.defined;
+            given @!types[$i] {
+                when MYSQL_TYPE_LONG | MYSQL_TYPE_LONGLONG { @!buffers[$i][0] = $value.Int }
+                when MYSQL_TYPE_DOUBLE { @!buffers[$i][0] = $value.Num }
+                default {
+                    # the char * that a CArray[Str] holds, encoded once
+                    # when stored; strlen counts its bytes in place
+                    my $string = CArray[Str].new;
+                    $string[0] = ~$value;
+                    @!strings.push: $string;
+                    my $chars = nativecast(CArray[OpaquePointer], $string)[0];
+                    @!binds[$i].point-at($chars);
+                    @!lengths[$i][0] = strlen($chars);
+                }
+            }
+        }
+        self!bind if $!strings-bound;
+        die "mysql_stmt_execute failed: {mysql_stmt_error($!stmt)}"
+            if mysql_stmt_execute($!stmt);
+    }
+
+    method close() {
+        mysql_stmt_close($!stmt);
+    }
+}
@@ -0,0 +1,177 @@
+module PQPrepared;
+
+# Prepared statements for PostgreSQL, with parameters sent in binary.
+# postgresqlclient.p6 puts values into the text of each statement, so
+# the server parses the statement again for every row, and every value
+# goes to text and back.  A PQStatement is parsed once by PQprepare, and
+# each execute sends only its values: integers and floats as the bytes
+# of the binary format, and strings as they are.
+#
+#   use lib 'examples';
+#   use PQPrepared;
+#   my $insert = PQStatement.new($conn, 'insert',
+#       'INSERT INTO t VALUES ($1, $2, $3)', INT8OID, TEXTOID, FLOAT8OID);
+#   $insert.execute($_, "row $_", $_ / 3e0) for ^100000;
+#
+# A Str type object sends NULL.  Pass :text to PQStatement.new to send
+# every value as text instead, which any type accepts.
+#
+# The library is libpq unless the PQPREPARED_LIBPQ environment variable
+# names another one when this module is compiled, which the tests and
+# bench/02-prepared.pl6 use to run against t/12-prepared.c.
+
+use NativeCall;
+
+constant LIBPQ = %*ENV<PQPREPARED_LIBPQ> // 'libpq';
+
+# from libpq-fe.h
+constant PGRES_COMMAND_OK = 1;
+constant PGRES_TUPLES_OK  = 2;
+
+# from pg_type.h, the types that have a binary format here
+constant INT8OID   is export = 20;
+constant INT4OID   is export = 23;
+constant TEXTOID   is export = 25;
+constant FLOAT8OID is export = 701;
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub PQclear( OpaquePointer $res )
+    is native(LIBPQ)
+    { ... }
+
+sub PQerrorMessage( OpaquePointer $conn )
+    returns Str
+    is native(LIBPQ)
+    { ... }
+
+sub PQexecPrepared( OpaquePointer $conn, Str $stmtName, int32 $nParams,
+    CArray[OpaquePointer] $paramValues, CArray[int32] $paramLengths,
+    CArray[int32] $paramFormats, int32 $resultFormat )
+    returns OpaquePointer
+    is native(LIBPQ)
+    { ... }
+
+sub PQprepare( OpaquePointer $conn, Str $stmtName, Str $query,
+    int32 $nParams, CArray[int32] $paramTypes )
+    returns OpaquePointer
+    is native(LIBPQ)
+    { ... }
+
+sub PQresultStatus( OpaquePointer $res )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+# ------------------------- binary parameters ---------------------------
+
+# Whether this machine puts the low byte of an integer first, while
+# the binary format of the server puts the high byte first
+my $little-endian;
+sub little-endian() {
+    unless $little-endian.defined {
+        my $one = CArray[int32].new;
+        $one[0] = 1;
+        $little-endian = nativecast(CArray[int8], $one)[0] == 1;
+    }
+    $little-endian;
+}
+
+# The signed $bytes byte integer that is stored as the bytes of $value
+# in network order
+sub network-order(Int $value, Int $bytes) is export {
+    return $value unless little-endian();
+    my $bits = 8 * $bytes;
+    my $v = $value % 2 ** $bits;
+    my $swapped = 0;
+    for ^$bytes {
+        $swapped = $swapped +< 8 +| ($v +& 0xff);
+        $v = $v +> 8;
+    }
+    $swapped >= 2 ** ($bits - 1) ?? $swapped - 2 ** $bits !! $swapped;
+}
+
+# A statement prepared on a connection, with one buffer for each binary
+# parameter that execute fills in, so that only the values change from
+# one row to the next.
+class PQStatement is export {
+    has $.conn;
+    has $.name;
+    has @.types;
+    has $.text;
+    has $!values;   # CArray[OpaquePointer], the paramValues
+    has $!lengths;  # CArray[int32]
+    has $!formats;  # CArray[int32], 1 for binary
+    has @!buffers;  # the value of each binary parameter
+    has @!pointers; # and where it is
+    has @!views;    # float8 buffers as int64, to put their bytes in order
+    has @!strings;  # CArray[Str] that own the text parameters
+
+    method new(OpaquePointer $conn, Str $name, Str $sql, *@types, :$text) {
+        my $oids = CArray[int32].new;
+        $oids[$_] = @types[$_] for ^@types;
+        my $res = PQprepare($conn, $name, $sql, +@types, $oids);
+        my $status = PQresultStatus($res);
+        PQclear($res);
+        die "PQprepare failed: {PQerrorMessage($conn)}" unless $status == PGRES_COMMAND_OK;
+        self.bless(:$conn, :$name, :@types, :text(?$text));
+    }
+
+    submethod BUILD(:$!conn, :$!name, :@!types, :$!text) {
+        $!values  = CArray[OpaquePointer].new;
+        $!lengths = CArray[int32].new;
+        $!formats = CArray[int32].new;
+        for @!types.kv -> $i, $type {
+            my $buffer;
+            given $!text ?? TEXTOID !! $type {
+                when INT4OID   { $buffer = CArray[int32].new; $!lengths[$i] = 4 }
+                when INT8OID   { $buffer = CArray[int64].new; $!lengths[$i] = 8 }
+                when FLOAT8OID { $buffer = CArray[num64].new; $!lengths[$i] = 8 }
+                default        { $!lengths[$i] = 0 }
+            }
+            $!formats[$i] = $buffer.defined ?? 1 !! 0;
+            $!values[$i]  = OpaquePointer;
+            if $buffer.defined {
+                $buffer[0] = 0;
+                @!buffers[$i]  = $buffer;
+                @!pointers[$i] = nativecast(OpaquePointer, $buffer);
+                @!views[$i] = nativecast(CArray[int64], $buffer) if $type == FLOAT8OID;
+            }
+        }
+    }
+
+    # Runs the statement with one value for each parameter
+    method execute(*@params) {
+        die "{+@params} values for {+@!types} parameters" unless @params == @!types;
+        @!strings = ();
+        for @params.kv -> $i, $value {
+            if !$value.defined {
+                $!values[$i] = OpaquePointer;
+            }
+            elsif !$!formats[$i] {
+                # text, as the char * that a CArray[Str] holds
+                my $string = CArray[Str].new;
+                $string[0] = ~$value;
+                @!strings.push: $string;
+                $!values[$i] = nativecast(CArray[OpaquePointer], $string)[0];
+            }
+            else {
+                my $buffer = @!buffers[$i];
+                given @!types[$i] {
+                    when INT4OID { $buffer[0] = network-order($value.Int, 4) }
+                    when INT8OID { $buffer[0] = network-order($value.Int, 8) }
+                    when FLOAT8OID {
+                        $buffer[0] = $value.Num;
+                        @!views[$i][0] = network-order(@!views[$i][0], 8);
+                    }
+                }
+                $!values[$i] = @!pointers[$i];
+            }
+        }
+        my $res = PQexecPrepared($!conn, $!name, +@!types, $!values, $!lengths, $!formats, 0);
+        my $status = PQresultStatus($res);
+        PQclear($res);
+        die "PQexecPrepared failed: {PQerrorMessage($!conn)}"
+            unless $status == PGRES_COMMAND_OK | PGRES_TUPLES_OK;
+    }
+}
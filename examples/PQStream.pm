@@ -0,0 +1,133 @@
+module PQStream;
+
+# Streaming query results from PostgreSQL with libpq's single row mode,
+# or chunked rows mode (libpq 17 and later), as a lazy Seq of rows.
+# PQexec keeps a whole result set in client memory before the first row
+# can be seen.  Here each row (or chunk of rows) is copied into Perl 6
+# and freed before the next one is read from the server, so an export
+# of any size runs in constant memory and starts producing at once.
+#
+#   use lib 'examples';
+#   use PQStream;
+#   for stream-rows($conn, 'SELECT * FROM big') -> @row { ... }
+#
+# Each row is an Array of Str, with the Str type object for NULL.  A
+# Seq that is not read to the end leaves the rest of the results on
+# the connection; call finish-stream before sending another query.
+#
+# The library is libpq unless the PQSTREAM_LIBPQ environment variable
+# names another one when this module is compiled.  The tests use that
+# to stream from a mock libpq (see t/11-pq-streaming.c).
+
+use NativeCall;
+
+constant LIBPQ = %*ENV<PQSTREAM_LIBPQ> // 'libpq';
+
+# from libpq-fe.h
+constant PGRES_COMMAND_OK   = 1;
+constant PGRES_TUPLES_OK    = 2;
+constant PGRES_SINGLE_TUPLE = 9;
+constant PGRES_TUPLES_CHUNK = 12;
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub PQclear( OpaquePointer $res )
+    is native(LIBPQ)
+    { ... }
+
+sub PQerrorMessage( OpaquePointer $conn )
+    returns Str
+    is native(LIBPQ)
+    { ... }
+
+sub PQgetisnull( OpaquePointer $res, int32 $tuplenum, int32 $fieldnum )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+sub PQgetResult( OpaquePointer $conn )
+    returns OpaquePointer
+    is native(LIBPQ)
+    { ... }
+
+sub PQgetvalue( OpaquePointer $res, int32 $tuplenum, int32 $fieldnum )
+    returns Str
+    is native(LIBPQ)
+    { ... }
+
+sub PQnfields( OpaquePointer $res )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+sub PQntuples( OpaquePointer $res )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+sub PQresultStatus( OpaquePointer $res )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+sub PQsendQuery( OpaquePointer $conn, Str $command )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+sub PQsetChunkedRowsMode( OpaquePointer $conn, int32 $chunkSize )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+sub PQsetSingleRowMode( OpaquePointer $conn )
+    returns int32
+    is native(LIBPQ)
+    { ... }
+
+# ------------------------------ wrapper --------------------------------
+
+# The rows of $query as a lazy Seq.  With :chunk(N) the server sends N
+# rows at a time, which costs fewer crossings per row but needs libpq
+# 17.  Dies with the server's message if the query fails, and if the
+# mode cannot be set, as when libpq is too old for chunked rows.
+sub stream-rows(OpaquePointer $conn, Str $query, Int :$chunk = 1) is export {
+    PQsendQuery($conn, $query)
+        or die "PQsendQuery failed: {PQerrorMessage($conn)}";
+    # Without either mode the whole result set would be read into memory
+    # before the first row, which is what streaming is there to avoid
+    unless $chunk > 1 ?? PQsetChunkedRowsMode($conn, $chunk) !! PQsetSingleRowMode($conn) {
+        finish-stream($conn);
+        die "Cannot set {$chunk > 1 ?? 'chunked rows' !! 'single row'} mode: {PQerrorMessage($conn)}";
+    }
+    gather loop {
+        my $res = PQgetResult($conn);
+        last unless $res.defined;
+        my $status = PQresultStatus($res);
+        unless $status == PGRES_SINGLE_TUPLE | PGRES_TUPLES_CHUNK
+                | PGRES_TUPLES_OK | PGRES_COMMAND_OK {
+            my $message = PQerrorMessage($conn);
+            PQclear($res);
+            finish-stream($conn);
+            die "query failed: $message";
+        }
+        # Copy the rows out and free the result before handing them on,
+        # so that nothing is left behind if the reader stops early
+        my $fields = PQnfields($res);
+        my @rows = (^PQntuples($res)).map: -> $row {
+            [ (^$fields).map: { PQgetisnull($res, $row, $_) ?? Str !! PQgetvalue($res, $row, $_) } ]
+        };
+        PQclear($res);
+        take $_ for @rows;
+    }
+}
+
+# Reads and frees whatever is left of a stream that was not read to
+# the end, so that the connection can take another query.
+sub finish-stream(OpaquePointer $conn) is export {
+    loop {
+        my $res = PQgetResult($conn);
+        last unless $res.defined;
+        PQclear($res);
+    }
+}
@@ -0,0 +1,129 @@
+class ShmRing;
+
+# A channel between processes made by fork(), through the ring of fixed
+# size records in shared memory of shmring.c.  One process pushes
+# records and one pops them; neither takes a lock, and a process that
+# waits sleeps on a futex on Linux.
+#
+#   use lib 'examples';
+#   use ShmRing;
+#   my $ring = ShmRing.new(capacity => 1024, record-size => 16);
+#   if fork() {
+#       $ring.push($records, :wait);  # a buf8 of whole records
+#       $ring.close;
+#   }
+#   else {
+#       while $ring.pop(64, :wait) -> $records { ... }
+#       exit 0;
+#   }
+#
+# Records are bytes, in a buf8 or a CArray; a buf8 from pop is a new
+# one, while pop-into fills a CArray of your own.  Make the ring before
+# forking, and destroy it in one process once both are done.  Build
+# shmring.c as described at the top of it, and run with LD_LIBRARY_PATH
+# set to where shmring.so is, or set SHMRING_LIB to the library.
+
+use NativeCall;
+
+constant LIB = %*ENV<SHMRING_LIB> // 'shmring';
+
+# -------- foreign function definitions in alphabetical order ----------
+
+sub fork() returns int32 is native(Str) is export { * }
+sub shmring_capacity(OpaquePointer) returns long is native(LIB) { * }
+sub shmring_close(OpaquePointer) is native(LIB) { * }
+sub shmring_create(long, long) returns OpaquePointer is native(LIB) { * }
+sub shmring_destroy(OpaquePointer) is native(LIB) { * }
+sub shmring_pop(OpaquePointer, buf8, long) returns long is native(LIB) { * }
+sub shmring_pop_carray(OpaquePointer, CArray, long) returns long is native(LIB) is symbol('shmring_pop') { * }
+sub shmring_pop_wait(OpaquePointer, buf8, long, long) returns long is native(LIB) { * }
+sub shmring_pop_wait_carray(OpaquePointer, CArray, long, long) returns long is native(LIB) is symbol('shmring_pop_wait') { * }
+sub shmring_push(OpaquePointer, buf8, long) returns long is native(LIB) { * }
+sub shmring_push_carray(OpaquePointer, CArray, long) returns long is native(LIB) is symbol('shmring_push') { * }
+sub shmring_push_wait(OpaquePointer, buf8, long, long) returns long is native(LIB) { * }
+sub shmring_push_wait_carray(OpaquePointer, CArray, long, long) returns long is native(LIB) is symbol('shmring_push_wait') { * }
+sub shmring_record_size(OpaquePointer) returns long is native(LIB) { * }
+sub shmring_size(OpaquePointer) returns long is native(LIB) { * }
+sub waitpid(int32, CArray[int32], int32) returns int32 is native(Str) { * }
+
+# Waits for the child process $pid to end, and returns its exit status
+sub wait-for(Int $pid) is export {
+    my $status = CArray[int32].allocate(1);
+    waitpid($pid, $status, 0);
+    ($status[0] +> 8) +& 0xff;
+}
+
+# ------------------------------- the ring ------------------------------
+
+# The milliseconds to wait for: forever with :wait, $timeout seconds
+# with :timeout, and not at all (Int) otherwise
+sub timeout-ms($wait, $timeout) {
+    $timeout.defined ?? ($timeout * 1000).Int !! $wait ?? -1 !! Int;
+}
+
+has OpaquePointer $!ring;
+has Int $.capacity;
+has Int $.record-size;
+
+# The capacity is rounded up to a power of 2
+method new(Int :$capacity!, Int :$record-size!) {
+    my $ring = shmring_create($capacity, $record-size);
+    die "Cannot map a ring of $capacity records of $record-size bytes" unless $ring.defined;
+    self.bless(:$ring, capacity => shmring_capacity($ring), :$record-size);
+}
+
+submethod BUILD(:$!ring, :$!capacity, :$!record-size) { }
+
+# Pushes the whole records of a buf8, or the first $count records of
+# a CArray, and returns how many fitted.  With :wait, or :timeout(N)
+# for at most N seconds, it waits until at least one fits.
+multi method push(buf8 $records, :$wait, :$timeout) {
+    my $count = $records.elems div $!record-size;
+    my $ms = timeout-ms($wait, $timeout);
+    $ms.defined
+        ?? shmring_push_wait($!ring, $records, $count, $ms)
+        !! shmring_push($!ring, $records, $count);
+}
+multi method push(CArray $records, Int $count, :$wait, :$timeout) {
+    my $ms = timeout-ms($wait, $timeout);
+    $ms.defined
+        ?? shmring_push_wait_carray($!ring, $records, $count, $ms)
+        !! shmring_push_carray($!ring, $records, $count);
+}
+
+# Pops up to $max records into a new buf8.  It is empty if there
+# were none in time, and Nil once the ring is closed and empty.
+method pop(Int $max = 1, :$wait, :$timeout) {
+    my $records = buf8.new;
+    $records[$max * $!record-size - 1] = 0;  # makes room for all of them at once
+    my $ms = timeout-ms($wait, $timeout);
+    my $count = $ms.defined
+        ?? shmring_pop_wait($!ring, $records, $max, $ms)
+        !! shmring_pop($!ring, $records, $max);
+    return Nil if $count < 0;
+    $count == $max ?? $records !! $records.subbuf(0, $count * $!record-size);
+}
+
+# Pops up to $max records into a CArray with room for them, and
+# returns how many, -1 once the ring is closed and empty
+method pop-into(CArray $records, Int $max, :$wait, :$timeout) {
+    my $ms = timeout-ms($wait, $timeout);
+    $ms.defined
+        ?? shmring_pop_wait_carray($!ring, $records, $max, $ms)
+        !! shmring_pop_carray($!ring, $records, $max);
+}
+
+# Tells the popping process that no more records will come
+method close() {
+    shmring_close($!ring);
+}
+
+# The number of records in the ring
+method elems() {
+    shmring_size($!ring);
+}
+
+method destroy() {
+    shmring_destroy($!ring) if $!ring.defined;
+    $!ring = OpaquePointer;
+}
@@ -0,0 +1,287 @@
+/* biggishint-bench.c */
+/* Benchmarks for the biggishint library.  Every result is printed as */
+/* one JSON object per line, so that runs can be compared by scripts. */
+/* Each operation is timed with every kernel set that the processor */
+/* supports (see biggishintKernels), at a range of operand sizes, and */
+/* reports the time and the number of heap allocations per operation */
+/* (see biggishintAllocations).  An operation name as the argument */
+/* runs only that operation.  Multiplication is also timed on 2, 4, 8 */
+/* and 16 threads if the library was built with BIGGISHINT_THREADS, */
+/* to show how it scales (see biggishintThreads), everything else runs */
+/* on one thread. */
+
+/* To build and run on Linux: */
+/*   cc -O2 -o biggishint-bench biggishint-bench.c biggishint.c */
+/*   ./biggishint-bench > bench_output.txt */
+/* or for the threaded multiplication: */
+/*   cc -O2 -pthread -DBIGGISHINT_THREADS -o biggishint-bench biggishint-bench.c biggishint.c */
+
+#define _POSIX_C_SOURCE 199309L  /* clock_gettime */
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* malloc free rand */
+#include <string.h>  /* strcmp */
+#include <time.h>    /* clock_gettime */
+#include "biggishint.h"
+
+/* Sizes of the operands in bits, from the smallest biggishint to ones */
+/* that need the 32-bit size header (more than 32766 words). */
+static int bench_sizes[] = { 16, 64, 256, 1024, 4096, 16384, 65536, 262144,
+    524208, 1048576, 4194304 };
+#define BENCH_SIZECOUNT (int) (sizeof(bench_sizes) / sizeof(bench_sizes[0]))
+
+/* Roughly how long to run each operation at each size */
+#define BENCH_TARGET_NS 200000000.0
+
+
+/* bench_now */
+/* Monotonic time in nanoseconds */
+static double
+bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/* bench_random */
+/* A random positive biggishint with exactly bits bits */
+static unsigned short *
+bench_random(int bits)
+{
+    int digits = (bits + 3) / 4, i;
+    char * hex = (char *) malloc(digits + 1);
+    unsigned short * bi1;
+    for (i=0; i<digits; ++i)
+        hex[i] = "0123456789abcdef"[rand() & 0xf];
+    hex[0] = "1248"[(bits + 3) % 4];  /* makes the top bit exact */
+    hex[digits] = '\0';
+    bi1 = biggishintFromHexadecimalString(hex);
+    free(hex);
+    return bi1;
+}
+
+
+/* bench_add */
+static void bench_add(unsigned short * bi1, unsigned short * bi2)
+{
+    biggishintFree(biggishintAdd(bi1, bi2));
+}
+
+
+/* bench_subtract */
+static void bench_subtract(unsigned short * bi1, unsigned short * bi2)
+{
+    biggishintFree(biggishintSubtract(bi1, bi2));
+}
+
+
+/* bench_compare */
+/* Compares a number with an equal copy, the worst case */
+static void bench_compare(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi2;
+    biggishintCompare(bi1, bi1);
+}
+
+
+/* bench_multiply */
+static void bench_multiply(unsigned short * bi1, unsigned short * bi2)
+{
+    biggishintFree(biggishintMultiply(bi1, bi2));
+}
+
+
+/* bench_divide */
+static void bench_divide(unsigned short * bi1, unsigned short * bi2)
+{
+    biggishintFree(biggishintDivide(bi1, bi2));
+}
+
+
+/* Shift distance, not a multiple of 16 so that bits cross words */
+static unsigned short * bench_shiftcount;
+
+
+/* bench_shiftleft */
+static void bench_shiftleft(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi2;
+    biggishintFree(biggishintShiftLeft(bi1, bench_shiftcount));
+}
+
+
+/* bench_shiftright */
+static void bench_shiftright(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi2;
+    biggishintFree(biggishintShiftRight(bi1, bench_shiftcount));
+}
+
+
+/* The first operand as strings, for the conversions from strings */
+static char * bench_hexstring, * bench_decimalstring;
+
+
+/* bench_tohex */
+static void bench_tohex(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi2;
+    free(biggishintToHexadecimalString(bi1));
+}
+
+
+/* bench_fromhex */
+static void bench_fromhex(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi1; (void) bi2;
+    biggishintFree(biggishintFromHexadecimalString(bench_hexstring));
+}
+
+
+/* The first operand as little endian bytes, for bench_frombytes */
+static unsigned char * bench_bytes;
+static long bench_bytecount;
+
+
+/* bench_tobytes */
+static void bench_tobytes(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi2;
+    biggishintToBytes(bi1, bench_bytes, bench_bytecount);
+}
+
+
+/* bench_frombytes */
+static void bench_frombytes(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi1; (void) bi2;
+    biggishintFree(biggishintFromBytes(bench_bytes, bench_bytecount, 0));
+}
+
+
+/* bench_todecimal */
+static void bench_todecimal(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi2;
+    free(biggishintToDecimalString(bi1));
+}
+
+
+/* bench_fromdecimal */
+static void bench_fromdecimal(unsigned short * bi1, unsigned short * bi2)
+{
+    (void) bi1; (void) bi2;
+    biggishintFree(biggishintFromDecimalString(bench_decimalstring));
+}
+
+
+struct bench_operation {
+    const char * name;
+    void      (* run)(unsigned short *, unsigned short *);
+    int          maxbits;    /* skip sizes above this, 0 for none */
+    int          halfsize;   /* second operand half as long as the first */
+    int          decimal;    /* needs bench_decimalstring */
+    int          threaded;   /* time it on several threads too */
+};
+
+/* Numbers of threads for the threaded operations */
+static int bench_threadcounts[] = { 1, 2, 4, 8, 16 };
+#define BENCH_THREADCOUNTCOUNT (int) (sizeof(bench_threadcounts) / sizeof(bench_threadcounts[0]))
+
+/* Products and quotients are quadratic, as are the decimal */
+/* conversions, so those stop at smaller sizes. */
+static struct bench_operation bench_operations[] = {
+    { "add",         bench_add,               0, 0, 0, 0 },
+    { "subtract",    bench_subtract,          0, 0, 0, 0 },
+    { "compare",     bench_compare,           0, 0, 0, 0 },
+    { "multiply",    bench_multiply,    1048576, 0, 0, 1 },
+    { "divide",      bench_divide,        65536, 1, 0, 0 },
+    { "shiftleft",   bench_shiftleft,         0, 0, 0, 0 },
+    { "shiftright",  bench_shiftright,        0, 0, 0, 0 },
+    { "tohex",       bench_tohex,             0, 0, 0, 0 },
+    { "fromhex",     bench_fromhex,           0, 0, 0, 0 },
+    { "tobytes",     bench_tobytes,           0, 0, 0, 0 },
+    { "frombytes",   bench_frombytes,         0, 0, 0, 0 },
+    { "todecimal",   bench_todecimal,    262144, 0, 0, 0 },
+    { "fromdecimal", bench_fromdecimal,  262144, 0, 1, 0 },
+};
+#define BENCH_OPERATIONCOUNT (int) (sizeof(bench_operations) / sizeof(bench_operations[0]))
+
+
+/* bench_run */
+/* Times one operation at one size, doubling the iteration count until */
+/* the run is long enough to measure */
+static void
+bench_run(struct bench_operation * operation, int bits, const char * kernels, int threads)
+{
+    unsigned short * bi1, * bi2;
+    long iterations, i;
+    unsigned long allocations;
+    double start, elapsed;
+    bi1 = bench_random(bits);
+    bi2 = bench_random(operation->halfsize ? (bits + 1) / 2
+                     : bits > 16 ? bits - 8 : bits);
+    bench_hexstring = biggishintToHexadecimalString(bi1);
+    bench_decimalstring = operation->decimal ? biggishintToDecimalString(bi1) : NULL;
+    bench_bytecount = biggishintToBytes(bi1, NULL, 0);
+    bench_bytes = (unsigned char *) malloc(bench_bytecount);
+    biggishintToBytes(bi1, bench_bytes, bench_bytecount);
+    for (iterations=1; ; iterations<<=1) {
+        allocations = biggishintAllocations();
+        start = bench_now();
+        for (i=0; i<iterations; ++i)
+            operation->run(bi1, bi2);
+        elapsed = bench_now() - start;
+        allocations = biggishintAllocations() - allocations;
+        if (elapsed > BENCH_TARGET_NS / 10 || iterations > (1L << 30))
+            break;
+    }
+    printf("{\"op\":\"%s\",\"bits\":%d,\"kernels\":\"%s\",\"threads\":%d,\"iterations\":%ld,"
+           "\"ns_per_op\":%.1f,\"allocations_per_op\":%.3f}\n",
+        operation->name, bits, kernels, threads, iterations, elapsed / iterations,
+        (double) allocations / iterations);
+    fflush(stdout);
+    free(bench_hexstring);
+    free(bench_bytes);
+    if (bench_decimalstring)
+        free(bench_decimalstring);
+    biggishintFree(bi1);
+    biggishintFree(bi2);
+}
+
+
+int
+main(int argc, char * argv[])
+{
+    const char * kernelsets[2], * only = argc > 1 ? argv[1] : NULL;
+    int kernelsetcount, k, o, s, t, threads;
+    /* Always time the portable kernels, and the native ones if any */
+    kernelsets[0] = "portable";
+    kernelsetcount = strcmp(biggishintKernels("auto"), "portable") ? 2 : 1;
+    kernelsets[1] = "auto";
+    bench_shiftcount = biggishintFromDecimalString("13");
+    for (o=0; o<BENCH_OPERATIONCOUNT; ++o) {
+        if (only && strcmp(only, bench_operations[o].name))
+            continue;
+        for (s=0; s<BENCH_SIZECOUNT; ++s) {
+            if (bench_operations[o].maxbits && bench_sizes[s] > bench_operations[o].maxbits)
+                continue;
+            for (k=0; k<kernelsetcount; ++k)
+                for (t=0; t<BENCH_THREADCOUNTCOUNT; ++t) {
+                    if (t && ! bench_operations[o].threaded)
+                        break;
+                    /* biggishintThreads stays at 1 if not built for threads */
+                    threads = biggishintThreads(bench_threadcounts[t]);
+                    if (threads != bench_threadcounts[t])
+                        break;
+                    bench_run(&bench_operations[o], bench_sizes[s],
+                        biggishintKernels((char *) kernelsets[k]), threads);
+                }
+        }
+    }
+    biggishintFree(bench_shiftcount);
+    return 0;
+}
+
+/* end of biggishint-bench.c */
@@ -0,0 +1,773 @@
+/* biggishint-test.c */
+/* Randomized differential test of the biggishint library.  Every */
+/* operation is checked against a separate, deliberately simple */
+/* reference implementation that stores numbers as sign and magnitude */
+/* with 64-bit limbs (little endian) and uses only schoolbook */
+/* algorithms.  The two meet through hexadecimal strings, so the */
+/* string conversions are tested along the way.  The output is TAP, */
+/* one test per operation, operand size and kernel set.  The second */
+/* pass, with the native kernels, also multiplies on 4 threads if the */
+/* library was built with BIGGISHINT_THREADS. */
+
+/* To build and run on Linux: */
+/*   cc -O2 -o biggishint-test biggishint-test.c biggishint.c */
+/*   ./biggishint-test [seed] */
+/* or with prove: prove -e '' ./biggishint-test */
+/* To also test threaded multiplication on small numbers, add */
+/*   -pthread -DBIGGISHINT_THREADS -DBIGGISHINT_THREAD_THRESHOLD=16 */
+
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* malloc calloc free atol */
+#include <string.h>  /* strcmp strlen memset memcpy */
+#include "biggishint.h"
+
+/* How many random cases per operation and size */
+#define TEST_CASES 40
+
+/* The largest size goes past 32766 words, the limit of the short */
+/* biggishint header.  It has fewer cases, because each one is slow. */
+#define TEST_LARGE       1048576
+#define TEST_LARGE_CASES 2
+
+
+/* ----------------------- Reference integers ----------------------- */
+
+typedef unsigned long long ref_limb;
+
+/* Sign and magnitude, d[0] least significant, no leading zero limbs, */
+/* zero has n == 0 and sign 0. */
+typedef struct {
+    int        sign;
+    int        n;
+    ref_limb * d;
+} ref_int;
+
+
+/* ref_new */
+static ref_int
+ref_new(int n)
+{
+    ref_int r;
+    r.sign = 0;
+    r.n = n;
+    r.d = (ref_limb *) calloc(n + 1, sizeof(ref_limb));
+    return r;
+}
+
+
+/* ref_norm */
+/* Drops leading zero limbs and the sign of zero */
+static ref_int
+ref_norm(ref_int r)
+{
+    while (r.n && r.d[r.n - 1] == 0)
+        --r.n;
+    if (r.n == 0)
+        r.sign = 0;
+    return r;
+}
+
+
+/* ref_copy */
+static ref_int
+ref_copy(ref_int a)
+{
+    ref_int r = ref_new(a.n);
+    memcpy(r.d, a.d, a.n * sizeof(ref_limb));
+    r.sign = a.sign;
+    return r;
+}
+
+
+/* ref_bit */
+static int
+ref_bit(ref_int a, long i)
+{
+    return (i >> 6) < a.n ? (int) ((a.d[i >> 6] >> (i & 63)) & 1) : 0;
+}
+
+
+/* ref_bits */
+/* Number of significant bits of the magnitude */
+static long
+ref_bits(ref_int a)
+{
+    long bits = (long) a.n * 64;
+    while (bits && ! ref_bit(a, bits - 1))
+        --bits;
+    return bits;
+}
+
+
+/* ref_tohex */
+static char *
+ref_tohex(ref_int a)
+{
+    char * s = (char *) malloc(a.n * 16 + 4), * p = s;
+    long nybbles = (ref_bits(a) + 3) / 4, i;
+    if (a.sign) * p++ = '-';
+    * p++ = '0'; * p++ = 'x';
+    if (nybbles == 0) * p++ = '0';
+    for (i=nybbles-1; i>=0; --i)
+        * p++ = "0123456789abcdef"[(a.d[i / 16] >> ((i % 16) * 4)) & 0xf];
+    * p = '\0';
+    return s;
+}
+
+
+/* ref_cmpmag */
+static int
+ref_cmpmag(ref_int a, ref_int b)
+{
+    int i;
+    if (a.n != b.n)
+        return a.n < b.n ? -1 : 1;
+    for (i=a.n-1; i>=0; --i)
+        if (a.d[i] != b.d[i])
+            return a.d[i] < b.d[i] ? -1 : 1;
+    return 0;
+}
+
+
+/* ref_cmp */
+static int
+ref_cmp(ref_int a, ref_int b)
+{
+    if (a.sign != b.sign)
+        return a.sign ? -1 : 1;
+    return a.sign ? ref_cmpmag(b, a) : ref_cmpmag(a, b);
+}
+
+
+/* ref_addmag */
+static ref_int
+ref_addmag(ref_int a, ref_int b)
+{
+    int n = a.n > b.n ? a.n : b.n, i;
+    ref_limb x, y, s, carry = 0;
+    ref_int r = ref_new(n + 1);
+    for (i=0; i<n; ++i) {
+        x = i < a.n ? a.d[i] : 0;
+        y = i < b.n ? b.d[i] : 0;
+        s = x + y;
+        r.d[i] = s + carry;
+        carry = (s < x) | (r.d[i] < s);
+    }
+    r.d[n] = carry;
+    return ref_norm(r);
+}
+
+
+/* ref_submag */
+/* |a| - |b|, where |a| >= |b| */
+static ref_int
+ref_submag(ref_int a, ref_int b)
+{
+    int i;
+    ref_limb y, borrow = 0;
+    ref_int r = ref_new(a.n);
+    for (i=0; i<a.n; ++i) {
+        y = i < b.n ? b.d[i] : 0;
+        r.d[i] = a.d[i] - y - borrow;
+        borrow = (a.d[i] < y) | (a.d[i] - y < borrow);
+    }
+    return ref_norm(r);
+}
+
+
+/* ref_add */
+/* a + b, or a - b when negate is set */
+static ref_int
+ref_add(ref_int a, ref_int b, int negate)
+{
+    int signb = b.sign ^ negate;
+    ref_int r;
+    if (a.sign == signb) {
+        r = ref_addmag(a, b);
+        r.sign = a.sign;
+    }
+    else if (ref_cmpmag(a, b) >= 0) {
+        r = ref_submag(a, b);
+        r.sign = a.sign;
+    }
+    else {
+        r = ref_submag(b, a);
+        r.sign = signb;
+    }
+    return ref_norm(r);
+}
+
+
+/* ref_mullimb */
+/* 64 x 64 bit multiply into high and low halves, without needing a */
+/* 128-bit type */
+static void
+ref_mullimb(ref_limb a, ref_limb b, ref_limb * hi, ref_limb * lo)
+{
+    ref_limb a0 = a & 0xffffffffULL, a1 = a >> 32;
+    ref_limb b0 = b & 0xffffffffULL, b1 = b >> 32;
+    ref_limb p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    ref_limb mid = (p00 >> 32) + (p01 & 0xffffffffULL) + (p10 & 0xffffffffULL);
+    * lo = (mid << 32) | (p00 & 0xffffffffULL);
+    * hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+
+/* ref_mul */
+static ref_int
+ref_mul(ref_int a, ref_int b)
+{
+    int i, j;
+    ref_limb hi, lo, carry;
+    ref_int r = ref_new(a.n + b.n);
+    for (i=0; i<a.n; ++i) {
+        carry = 0;
+        for (j=0; j<b.n; ++j) {
+            ref_mullimb(a.d[i], b.d[j], &hi, &lo);
+            lo += r.d[i + j];
+            hi += lo < r.d[i + j];
+            lo += carry;
+            hi += lo < carry;
+            r.d[i + j] = lo;
+            carry = hi;
+        }
+        r.d[i + b.n] = carry;
+    }
+    r.sign = a.sign ^ b.sign;
+    return ref_norm(r);
+}
+
+
+/* ref_divmod */
+/* Truncating division one bit at a time, remainder has the sign of a */
+static void
+ref_divmod(ref_int a, ref_int b, ref_int * q, ref_int * m)
+{
+    long i;
+    int width = b.n + 1, j;
+    ref_limb y, borrow;
+    ref_int r = ref_new(width), view;
+    * q = ref_new(a.n);
+    for (i=ref_bits(a)-1; i>=0; --i) {
+        for (j=width-1; j>0; --j)  /* r = r * 2 + bit */
+            r.d[j] = (r.d[j] << 1) | (r.d[j-1] >> 63);
+        r.d[0] = (r.d[0] << 1) | (ref_limb) ref_bit(a, i);
+        view = r;
+        view.n = width;
+        if (ref_cmpmag(ref_norm(view), b) >= 0) {
+            for (j=0, borrow=0; j<width; ++j) {
+                y = j < b.n ? b.d[j] : 0;
+                y += borrow;
+                borrow = y < borrow || r.d[j] < y;
+                r.d[j] -= y;
+            }
+            q->d[i >> 6] |= (ref_limb) 1 << (i & 63);
+        }
+    }
+    q->sign = a.sign ^ b.sign;
+    * q = ref_norm(* q);
+    r.n = width;
+    r.sign = a.sign;
+    * m = ref_norm(r);
+}
+
+
+/* ref_shl */
+/* Multiplies by 2**count, count may be negative (floor division) */
+static ref_int
+ref_shl(ref_int a, long count)
+{
+    long i, bits = ref_bits(a);
+    int lost = 0;
+    ref_int r;
+    if (count >= 0) {
+        r = ref_new((int) ((bits + count) / 64 + 1));
+        for (i=0; i<bits; ++i)
+            if (ref_bit(a, i))
+                r.d[(i + count) >> 6] |= (ref_limb) 1 << ((i + count) & 63);
+    }
+    else {
+        count = -count;
+        r = ref_new(a.n + 1);
+        for (i=0; i<bits; ++i)
+            if (ref_bit(a, i)) {
+                if (i >= count)
+                    r.d[(i - count) >> 6] |= (ref_limb) 1 << ((i - count) & 63);
+                else
+                    lost = 1;
+            }
+        if (a.sign && lost) {  /* round towards minus infinity */
+            ref_int one = ref_new(1), t;
+            one.d[0] = 1;
+            t = ref_addmag(ref_norm(r), one);
+            free(r.d); free(one.d);
+            r = t;
+        }
+    }
+    r.sign = a.sign;
+    return ref_norm(r);
+}
+
+
+/* ref_bitwise */
+/* &, | or ^ in two's complement, one limb wider than either operand */
+static ref_int
+ref_bitwise(ref_int a, ref_int b, char op)
+{
+    int n = (a.n > b.n ? a.n : b.n) + 1, i, sign;
+    ref_limb x, y, carryx = 1, carryy = 1, carryr = 1;
+    ref_int r = ref_new(n);
+    for (i=0; i<n; ++i) {
+        x = i < a.n ? a.d[i] : 0;
+        y = i < b.n ? b.d[i] : 0;
+        if (a.sign) { x = ~x + carryx; carryx = carryx && x == 0; }
+        if (b.sign) { y = ~y + carryy; carryy = carryy && y == 0; }
+        r.d[i] = op == '&' ? x & y : op == '|' ? x | y : x ^ y;
+    }
+    sign = (int) (r.d[n-1] >> 63);
+    if (sign)
+        for (i=0; i<n; ++i) {
+            r.d[i] = ~r.d[i] + carryr;
+            carryr = carryr && r.d[i] == 0;
+        }
+    r.sign = sign;
+    return ref_norm(r);
+}
+
+
+/* ref_pow */
+static ref_int
+ref_pow(ref_int a, long e)
+{
+    ref_int r = ref_new(1), t;
+    r.d[0] = 1;
+    for ( ; e > 0; --e) {
+        t = ref_mul(r, a);
+        free(r.d);
+        r = t;
+    }
+    return ref_norm(r);
+}
+
+
+/* ref_powmod */
+/* Right to left square and multiply, result from 0 to |m|-1 */
+static ref_int
+ref_powmod(ref_int a, ref_int e, ref_int m)
+{
+    long i, bits = ref_bits(e);
+    ref_int r = ref_new(1), base, q, t, s;
+    m.sign = 0;
+    r.d[0] = 1;
+    ref_divmod(r, m, &q, &t);  free(q.d); free(r.d); r = t;
+    ref_divmod(a, m, &q, &base);  free(q.d);
+    if (base.sign) { t = ref_add(base, m, 0); free(base.d); base = t; }
+    for (i=0; i<bits; ++i) {
+        if (ref_bit(e, i)) {
+            s = ref_mul(r, base);
+            ref_divmod(s, m, &q, &t);
+            free(s.d); free(q.d); free(r.d);
+            r = t;
+        }
+        s = ref_mul(base, base);
+        ref_divmod(s, m, &q, &t);
+        free(s.d); free(q.d); free(base.d);
+        base = t;
+    }
+    free(base.d);
+    return r;
+}
+
+
+/* ref_gcd */
+/* Binary greatest common divisor of the magnitudes, the plain way */
+static ref_int
+ref_gcd(ref_int a, ref_int b)
+{
+    ref_int u = ref_copy(a), v = ref_copy(b), t;
+    long shift = 0;
+    u.sign = v.sign = 0;
+    if (u.n == 0) { free(u.d); return v; }
+    if (v.n == 0) { free(v.d); return u; }
+    while (! ref_bit(u, 0) && ! ref_bit(v, 0)) {
+        t = ref_shl(u, -1); free(u.d); u = t;
+        t = ref_shl(v, -1); free(v.d); v = t;
+        ++shift;
+    }
+    while (u.n) {
+        while (! ref_bit(u, 0)) { t = ref_shl(u, -1); free(u.d); u = t; }
+        while (! ref_bit(v, 0)) { t = ref_shl(v, -1); free(v.d); v = t; }
+        if (ref_cmp(u, v) >= 0) { t = ref_add(u, v, 1); free(u.d); u = t; }
+        else                    { t = ref_add(v, u, 1); free(v.d); v = t; }
+    }
+    free(u.d);
+    t = ref_shl(v, shift);
+    free(v.d);
+    return t;
+}
+
+
+/* ref_todec */
+/* Decimal string by repeated division by 10**9 on 32-bit halves */
+static char *
+ref_todec(ref_int a)
+{
+    int halves = a.n * 2, i, len = 0, j;
+    unsigned int * h = (unsigned int *) calloc(halves + 1, sizeof(unsigned int));
+    char * digits = (char *) malloc(a.n * 20 + 12), * s, * p;
+    ref_limb rem;
+    for (i=0; i<a.n; ++i) {
+        h[2*i]   = (unsigned int) a.d[i];
+        h[2*i+1] = (unsigned int) (a.d[i] >> 32);
+    }
+    while (halves && h[halves-1] == 0) --halves;
+    do {
+        rem = 0;
+        for (i=halves-1; i>=0; --i) {
+            rem = (rem << 32) | h[i];
+            h[i] = (unsigned int) (rem / 1000000000);
+            rem %= 1000000000;
+        }
+        while (halves && h[halves-1] == 0) --halves;
+        for (j=0; j<9 && (halves || rem); ++j, rem /= 10)
+            digits[len++] = (char) ('0' + rem % 10);
+    } while (halves);
+    if (len == 0) digits[len++] = '0';
+    s = p = (char *) malloc(len + 2);
+    if (a.sign) * p++ = '-';
+    while (len) * p++ = digits[--len];
+    * p = '\0';
+    free(h); free(digits);
+    return s;
+}
+
+
+/* ------------------------- Test framework ------------------------- */
+
+static unsigned long long test_state = 88172645463325252ULL;
+static int test_number = 0;
+
+
+/* test_random */
+/* xorshift64, so the cases are the same on every platform */
+static ref_limb
+test_random(void)
+{
+    test_state ^= test_state << 13;
+    test_state ^= test_state >> 7;
+    test_state ^= test_state << 17;
+    return test_state;
+}
+
+
+/* test_operand */
+/* A random number of up to maxbits bits.  Some limbs are all zeroes */
+/* or all ones, to exercise carries and borrows.  Large operands are */
+/* at least 3/4 of maxbits, so that they really are large. */
+static ref_int
+test_operand(long maxbits)
+{
+    long bits = maxbits > 100000
+        ? maxbits - (long) (test_random() % (maxbits / 4 + 1))
+        : (long) (test_random() % (maxbits + 1));
+    int n = (int) ((bits + 63) / 64), i, kind;
+    ref_int r = ref_new(n);
+    kind = (int) (test_random() % 4);
+    for (i=0; i<n; ++i)
+        r.d[i] = kind == 0 ? ~0ULL
+               : kind == 1 && test_random() % 2 ? 0
+               : test_random();
+    if (n && bits % 64)
+        r.d[n-1] &= ((ref_limb) 1 << (bits % 64)) - 1;
+    r.sign = (int) (test_random() % 2);
+    return ref_norm(r);
+}
+
+
+/* test_hex */
+/* Converts a biggishint to hex, frees it (unless keep) */
+static char *
+test_hex(unsigned short * bi1, int keep)
+{
+    char * s;
+    if (bi1 == NULL) {
+        s = (char *) malloc(5);
+        strcpy(s, "NULL");
+        return s;
+    }
+    s = biggishintToHexadecimalString(bi1);
+    if (! keep)
+        biggishintFree(bi1);
+    return s;
+}
+
+
+/* test_bits */
+/* The operand size for an operation at a given size, 0 to skip it. */
+/* At TEST_LARGE the quadratic operations get smaller operands, which */
+/* still make results past the short header limit, and the ones that */
+/* need the (very slow) reference division are left out. */
+static long
+test_bits(const char * op, long bits)
+{
+    if (bits < TEST_LARGE)
+        return bits;
+    if (! strcmp(op, "multiply"))
+        return bits * 3 / 8;
+    if (! strcmp(op, "todecimal") || ! strcmp(op, "fromdecimal"))
+        return bits * 5 / 8;
+    if (! strcmp(op, "decimalbatch"))
+        return bits * 3 / 8;
+    if (! strcmp(op, "divide") || ! strcmp(op, "modulo")
+            || ! strcmp(op, "power") || ! strcmp(op, "powermodulo")
+            || ! strcmp(op, "gcd"))
+        return 0;
+    return bits;
+}
+
+
+/* test_operation */
+/* Runs TEST_CASES random cases of one operation and prints one TAP */
+/* line, with a diagnostic for the first failure. */
+static void
+test_operation(const char * op, long bits, const char * kernels)
+{
+    int c, ok = 1, cases = bits < TEST_LARGE ? TEST_CASES : TEST_LARGE_CASES;
+    long count;
+    ref_int a, b, m, q, r, expect;
+    char * ha, * hb, * hm, * want, * got;
+    unsigned short * bi1, * bi2, * bi3;
+    bits = test_bits(op, bits);
+    for (c=0; c<cases && ok; ++c) {
+        a = test_operand(bits);
+        b = test_operand(bits);
+        m = test_operand(bits);
+        ha = ref_tohex(a); hb = ref_tohex(b); hm = ref_tohex(m);
+        bi1 = biggishintFromHexadecimalString(ha);
+        bi2 = biggishintFromHexadecimalString(hb);
+        bi3 = biggishintFromHexadecimalString(hm);
+        want = got = NULL;
+        if (! strcmp(op, "add")) {
+            expect = ref_add(a, b, 0);
+            got = test_hex(biggishintAdd(bi1, bi2), 0);
+        }
+        else if (! strcmp(op, "subtract")) {
+            expect = ref_add(a, b, 1);
+            got = test_hex(biggishintSubtract(bi1, bi2), 0);
+        }
+        else if (! strcmp(op, "multiply")) {
+            expect = ref_mul(a, b);
+            got = test_hex(biggishintMultiply(bi1, bi2), 0);
+        }
+        else if (! strcmp(op, "divide") || ! strcmp(op, "modulo")) {
+            if (b.n == 0) {  /* no division by zero */
+                free(b.d); b = ref_new(1); b.d[0] = 7;
+                free(hb); hb = ref_tohex(b);
+                biggishintFree(bi2); bi2 = biggishintFromHexadecimalString(hb);
+            }
+            ref_divmod(a, b, &q, &r);
+            if (op[0] == 'd') { expect = q; free(r.d); }
+            else              { expect = r; free(q.d); }
+            got = test_hex(op[0] == 'd' ? biggishintDivide(bi1, bi2)
+                                        : biggishintModulo(bi1, bi2), 0);
+        }
+        else if (! strcmp(op, "compare")) {
+            /* compare a number with itself sometimes */
+            int result = biggishintCompare(bi1, c % 4 ? bi2 : bi1);
+            expect = ref_new(1);
+            expect.d[0] = (ref_limb) (ref_cmp(a, c % 4 ? b : a) + 1);
+            expect = ref_norm(expect);
+            got = (char *) malloc(24);
+            sprintf(got, "0x%d", result + 1);
+        }
+        else if (! strcmp(op, "shiftleft") || ! strcmp(op, "shiftright")) {
+            char countstring[24];
+            unsigned short * bicount;
+            count = (long) (test_random() % (2 * bits + 1)) - bits;
+            sprintf(countstring, "%ld", count);
+            bicount = biggishintFromDecimalString(countstring);
+            expect = ref_shl(a, op[5] == 'l' ? count : -count);
+            got = test_hex(op[5] == 'l' ? biggishintShiftLeft(bi1, bicount)
+                                        : biggishintShiftRight(bi1, bicount), 0);
+            biggishintFree(bicount);
+        }
+        else if (! strcmp(op, "and") || ! strcmp(op, "or") || ! strcmp(op, "xor")) {
+            expect = ref_bitwise(a, b, op[0] == 'a' ? '&' : op[0] == 'o' ? '|' : '^');
+            got = test_hex(op[0] == 'a' ? biggishintBitwiseAnd(bi1, bi2)
+                         : op[0] == 'o' ? biggishintBitwiseOr(bi1, bi2)
+                         :                biggishintBitwiseXor(bi1, bi2), 0);
+        }
+        else if (! strcmp(op, "not")) {
+            ref_int one = ref_new(1);
+            one.d[0] = 1;
+            one = ref_norm(one);
+            expect = ref_add(a, one, 0);  /* ~a == -(a + 1) */
+            expect.sign = expect.n ? ! expect.sign : 0;
+            free(one.d);
+            got = test_hex(biggishintBitwiseNot(bi1), 0);
+        }
+        else if (! strcmp(op, "power")) {
+            char exponentstring[8];
+            unsigned short * biexponent;
+            ref_int small = test_operand(bits < 64 ? bits : 64);
+            count = (long) (test_random() % 9);
+            sprintf(exponentstring, "%ld", count);
+            biexponent = biggishintFromDecimalString(exponentstring);
+            biggishintFree(bi1);
+            free(ha); ha = ref_tohex(small);
+            bi1 = biggishintFromHexadecimalString(ha);
+            expect = ref_pow(small, count);
+            got = test_hex(biggishintPower(bi1, biexponent), 0);
+            biggishintFree(biexponent);
+            free(small.d);
+        }
+        else if (! strcmp(op, "powermodulo")) {
+            /* keep the exponent short, the reference is slow */
+            ref_int e = test_operand(bits < 64 ? bits : 64);
+            unsigned short * biexponent;
+            char * he;
+            e.sign = 0;
+            he = ref_tohex(e);
+            biexponent = biggishintFromHexadecimalString(he);
+            if (m.n == 0) {
+                free(m.d); m = ref_new(1); m.d[0] = 7;
+                free(hm); hm = ref_tohex(m);
+                biggishintFree(bi3); bi3 = biggishintFromHexadecimalString(hm);
+            }
+            expect = ref_powmod(a, e, m);
+            got = test_hex(biggishintPowerModulo(bi1, biexponent, bi3), 0);
+            biggishintFree(biexponent);
+            free(he); free(e.d);
+        }
+        else if (! strcmp(op, "todecimal")) {
+            want = ref_todec(a);
+            got = biggishintToDecimalString(bi1);
+            expect = ref_new(0);
+        }
+        else if (! strcmp(op, "fromdecimal")) {
+            char * decimal = ref_todec(a);
+            expect = ref_copy(a);
+            got = test_hex(biggishintFromDecimalString(decimal), 0);
+            free(decimal);
+        }
+        else if (! strcmp(op, "sumbatch")) {
+            /* a, b, m and five more */
+            unsigned short * bis[8];
+            ref_int t;
+            int i;
+            bis[0] = bi1; bis[1] = bi2; bis[2] = bi3;
+            expect = ref_add(a, b, 0);
+            t = ref_add(expect, m, 0); free(expect.d); expect = t;
+            for (i=3; i<8; ++i) {
+                ref_int extra = test_operand(bits);
+                char * hextra = ref_tohex(extra);
+                bis[i] = biggishintFromHexadecimalString(hextra);
+                t = ref_add(expect, extra, 0); free(expect.d); expect = t;
+                free(hextra); free(extra.d);
+            }
+            got = test_hex(biggishintSumBatch(bis, 8), 0);
+            biggishintFreeBatch(bis + 3, 5);
+        }
+        else if (! strcmp(op, "decimalbatch")) {
+            /* a, b and m through one string each way */
+            unsigned short * bis[4];
+            char * da = ref_todec(a), * db = ref_todec(b), * dm = ref_todec(m);
+            char * joined = (char *) malloc(strlen(da) + strlen(db) + strlen(dm) + 8);
+            int found;
+            if (joined == NULL)
+                exit(1);
+            sprintf(joined, " %s\t%s \n%s ", da, db, dm);
+            found = biggishintFromDecimalStringBatch(bis, joined, 4);
+            sprintf(joined, "%s\n%s\n%s", da, db, dm);
+            want = joined;
+            got = found == 3 ? biggishintToDecimalStringBatch(bis, 3) : test_hex(NULL, 0);
+            if (found == 3)
+                biggishintFreeBatch(bis, 3);
+            expect = ref_new(0);
+            free(da); free(db); free(dm);
+        }
+        else if (! strcmp(op, "gcd")) {
+            /* a and b times a common factor m, so that the result is */
+            /* usually more than 1 */
+            ref_int am = ref_mul(a, m), bm = ref_mul(b, m);
+            char * ham = ref_tohex(am), * hbm = ref_tohex(bm);
+            unsigned short * biam = biggishintFromHexadecimalString(ham);
+            unsigned short * bibm = biggishintFromHexadecimalString(hbm);
+            expect = ref_gcd(am, bm);
+            got = test_hex(biggishintGreatestCommonDivisor(biam, bibm), 0);
+            biggishintFree(biam); biggishintFree(bibm);
+            free(ham); free(hbm); free(am.d); free(bm.d);
+        }
+        else if (! strcmp(op, "bytes")) {
+            /* out to little endian bytes, checked against the limbs */
+            /* of a, and back in again */
+            long needed = biggishintToBytes(bi1, NULL, 0), i;
+            unsigned char * bytes = (unsigned char *) malloc(needed);
+            int sign = biggishintSign(bi1);
+            expect = ref_copy(a);
+            biggishintToBytes(bi1, bytes, needed);
+            for (i=0; i<needed; ++i)
+                if (bytes[i] != (unsigned char) ((i >> 3) < a.n ? a.d[i >> 3] >> ((i & 7) << 3) : 0))
+                    break;
+            if (i < needed || needed != (ref_bits(a) + 7) / 8 + (a.n == 0)
+                    || sign != (a.n == 0 ? 0 : a.sign ? -1 : 1))
+                got = test_hex(NULL, 0);
+            else
+                got = test_hex(biggishintFromBytes(bytes, needed, sign < 0), 0);
+            free(bytes);
+        }
+        else {  /* "hexadecimal": round trip through the string */
+            expect = ref_copy(a);
+            got = test_hex(bi1, 1);
+        }
+        if (want == NULL)
+            want = ref_tohex(expect);
+        if (strcmp(want, got)) {
+            ok = 0;
+            printf("# %s failed with %s kernels\n#   a = %.200s\n#   b = %.200s\n#   m = %.200s\n"
+                   "#   expected %.200s\n#   got      %.200s\n",
+                   op, kernels, ha, hb, hm, want, got);
+        }
+        free(want); free(got); free(expect.d);
+        free(a.d); free(b.d); free(m.d);
+        free(ha); free(hb); free(hm);
+        biggishintFree(bi1); biggishintFree(bi2); biggishintFree(bi3);
+    }
+    printf("%sok %d - %s up to %ld bits (%s, %d thread%s)\n", ok ? "" : "not ",
+        ++test_number, op, bits, kernels, biggishintThreads(0),
+        biggishintThreads(0) == 1 ? "" : "s");
+    fflush(stdout);
+}
+
+
+int
+main(int argc, char * argv[])
+{
+    static const char * operations[] = {
+        "hexadecimal", "fromdecimal", "todecimal", "compare", "add",
+        "subtract", "multiply", "divide", "modulo", "shiftleft",
+        "shiftright", "and", "or", "xor", "not", "power", "powermodulo",
+        "sumbatch", "decimalbatch", "bytes", "gcd"
+    };
+    static long sizes[] = { 16, 64, 256, 1024, 4096, TEST_LARGE };
+    static const char * kernelsets[] = { "portable", "auto" };
+    int operationcount = sizeof(operations) / sizeof(operations[0]);
+    int sizecount = sizeof(sizes) / sizeof(sizes[0]), k, o, s, tests = 0;
+    if (argc > 1)
+        test_state = (unsigned long long) atol(argv[1]) | 1;
+    for (o=0; o<operationcount; ++o)
+        for (s=0; s<sizecount; ++s)
+            tests += test_bits(operations[o], sizes[s]) != 0;
+    printf("1..%d\n", 2 * tests);
+    for (k=0; k<2; ++k) {
+        const char * kernels = biggishintKernels((char *) kernelsets[k]);
+        biggishintThreads(k ? 4 : 1);
+        for (o=0; o<operationcount; ++o)
+            for (s=0; s<sizecount; ++s)
+                if (test_bits(operations[o], sizes[s]))
+                    test_operation(operations[o], sizes[s], kernels);
+    }
+    return 0;
+}
+
+/* end of biggishint-test.c */
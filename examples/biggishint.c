@@ -1,8 +1,9 @@
 /* biggishint.c */
 /* Biggish integers in this library are arrays of up 32766 16-bit */
 /* (unsigned short) integers for arbitrary precision integer */
-/* arithmetic up to 524240-bit (16*32765 bit) numbers.  A biggish */
-/* rational library (biggishrat) using these is also being developed. */
+/* arithmetic up to 524240-bit (16*32765 bit) numbers, or with a */
+/* bigger header, up to 4294967294 of them.  A biggish */
+/* rational library (biggishrat.c) is built on these. */
 
 /* The data format for these (fairly) big integers is an array of  */
 /* short ints allocated on the heap, with the following layout: */
@@ -15,6 +16,19 @@
 /* +-----------------+--------------+---------------+---------------+ */
 /* Word 0 uses 14 bits for the size in units of pairs of short ints, */
 /* 1 bit for overflow/underflow and 1 bit for (minus) sign. */
+/* Biggishints of more than 32766 words have 0 in the 14 size bits */
+/* and a 32-bit size (in words, high word first) in the two words */
+/* just before word 0, allocated together with the rest: */
+/* +--------------+--------------+-----------------+----------------+ */
+/* |   word -2    |   word -1    |     word 0      | word 1 etc     | */
+/* | size (high)  | size (low)   | 14 bits: 0      | 16 bits: int   | */
+/* |              |              | overflow, sign  |                | */
+/* +--------------+--------------+-----------------+----------------+ */
+/* A pointer to a biggishint always points to word 0, so the sign, the */
+/* overflow bit and the data words are in the same places for both */
+/* sizes of header, and only the code that reads or writes the size */
+/* (see BIGGISHINT_SIZE and BIGGISHINT_HEADER) needs to know.  The */
+/* two size words exist if and only if the size bits of word 0 are 0. */
 /* The remaining words are all unsigned short integers, always an odd */
 /* number of them because of word 0 and the even array size.  Thus */
 /* memory allocation occurs in multiples of 4 bytes, a nice alignment */
@@ -24,7 +38,8 @@
 /* +65535, the next size (8 bytes) spans -281474976710656 (-2^48) to */
 /* +281474976710655 (+2^48-1), and so on to the largest (65532 bytes) */
 /* calculating from about -9.22e157811 (-2^524240) to about */
-/* +9.22e157811 (+2^524240-1). */
+/* +9.22e157811 (+2^524240-1).  With the 32-bit size header they go */
+/* on up to 4294967294 words, about 2^68719476704. */
 
 /* The word order is big endian, no matter what the byte order of the */
 /* processor may be.  There is no reason for this, it just is. */
@@ -38,8 +53,8 @@
 /* instead if every possible C compiler had a 64-bit data type to do */
 /* carries, but this is not the case. */
 
-/* Functions set the overflow bit if the result does not fit in 32766 */
-/* words (including the initial size word).  If the overflow bit is */
+/* Functions set the overflow bit if the result does not fit in */
+/* 4294967294 words (including the initial size word).  If the overflow bit is */
 /* set the other fields change their meaning: */
 /* * The sign bit indicates positive overflow or negative overflow. */
 /* * The integer value is unusable, and is therefore reduced to the */
@@ -53,6 +68,19 @@
 /* See also: a much bigger library: http://gmplib.org/manual/ */
 /* Donald E. Knuth The Art of Computer Programming Vol 2 */
 
+/* Allocation goes through biggishint_internal_alloc() and */
+/* biggishint_internal_free().  The two smallest sizes (4 and 8 bytes) */
+/* are by far the most common, so freed blocks of those sizes are kept */
+/* on per-thread free lists and handed out again instead of going back */
+/* to malloc.  Compile with -DBIGGISHINT_NO_POOL to disable this. */
+
+/* The functions whose names end in Batch do one operation on a whole */
+/* array of biggishints, so that a caller in Perl 6 pays for one */
+/* NativeCall crossing instead of one per number. */
+
+/* Compile with -DBIGGISHINT_THREADS (and -pthread) to multiply large */
+/* numbers on several threads, see biggishintThreads. */
+
 /* TODO: overflow detection */
 /* TODO: change from big endian to little endian */
 
@@ -68,20 +96,157 @@
 #error In this C compiler a short int is not a 16 bit number.
 #endif
 
+/* Montgomery multiplication in biggishintPowerModulo works on little */
+/* endian arrays of digits.  Use 32-bit digits where the C compiler */
+/* has a 64-bit type to do the carries, otherwise 16-bit digits.  The */
+/* decimal conversions use the same type for their carries, and work */
+/* on chunks of as many decimal digits as a 16-bit word times the */
+/* chunk size leaves room for. */
+#if defined(ULLONG_MAX) && UINT_MAX == 0xffffffff
+typedef unsigned int       biggishint_internal_digit;
+typedef unsigned long long biggishint_internal_doubledigit;
+#define BIGGISHINT_DIGIT_WORDS 2
+#define BIGGISHINT_DECIMAL_DIGITS 9
+#define BIGGISHINT_DECIMAL_CHUNK  1000000000UL
+#else
+typedef unsigned short     biggishint_internal_digit;
+typedef unsigned long      biggishint_internal_doubledigit;
+#define BIGGISHINT_DIGIT_WORDS 1
+#define BIGGISHINT_DECIMAL_DIGITS 4
+#define BIGGISHINT_DECIMAL_CHUNK  10000UL
+#endif
+#define BIGGISHINT_DIGIT_BITS (BIGGISHINT_DIGIT_WORDS << 4)
+
+/* The size of a biggishint in words, from either kind of header, and */
+/* the word 0 (without the sign) for a new biggishint of a given size. */
+/* biggishint_internal_alloc writes the two extra size words of large */
+/* biggishints, so a new one only needs word 0 from BIGGISHINT_HEADER. */
+#define BIGGISHINT_MAXSHORTSIZE 32766UL
+#define BIGGISHINT_MAXSIZE      0xfffffffeUL
+#define BIGGISHINT_SIZE(bi) \
+    ((* (bi) & 0xfffc) ? (unsigned long) ((* (bi) & 0xfffc) >> 1) \
+                       : ((unsigned long) (bi)[-2] << 16) | (bi)[-1])
+#define BIGGISHINT_HEADER(size) \
+    ((size) > BIGGISHINT_MAXSHORTSIZE ? 0 : (unsigned short) ((size) << 1))
+
+/* On x86-64 with gcc or clang, add, subtract and compare have extra */
+/* kernels that use ADX and AVX2 instructions.  They are chosen at run */
+/* time according to what the processor supports, the portable C ones */
+/* are used otherwise.  Compile with -DBIGGISHINT_PORTABLE to omit */
+/* them entirely. */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(BIGGISHINT_PORTABLE)
+#define BIGGISHINT_X86_64
+#include <immintrin.h>  /* _addcarryx_u64 _subborrow_u64 _mm256_* */
+#endif
+
+/* Multiplications where both numbers have at least */
+/* BIGGISHINT_THREAD_THRESHOLD words are split between threads, each */
+/* getting at least half that many rows of the longer number. */
+#ifdef BIGGISHINT_THREADS
+#include <pthread.h>  /* pthread_create pthread_mutex_* pthread_cond_* */
+#include <unistd.h>   /* sysconf */
+#ifndef BIGGISHINT_THREAD_THRESHOLD
+#define BIGGISHINT_THREAD_THRESHOLD 1024
+#endif
+#define BIGGISHINT_MAXTHREADS 64
+#endif
+
+/* Each thread gets its own free lists so that the pool needs no locks, */
+/* and its own count of heap allocations (see biggishintAllocations). */
+#if defined(_MSC_VER)
+#define BIGGISHINT_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define BIGGISHINT_THREAD_LOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define BIGGISHINT_THREAD_LOCAL _Thread_local
+#else
+#define BIGGISHINT_THREAD_LOCAL  /* none, so the counts are shared */
+#ifndef BIGGISHINT_NO_POOL
+#define BIGGISHINT_NO_POOL  /* no thread local storage, so no pool */
+#endif
+#endif
+static BIGGISHINT_THREAD_LOCAL unsigned long biggishint_allocations;
+
 /* #define BIGGISHINT_TRACE */
 
 /* Internal functions are declared here, their definitions are lower */
 /* down. */
 unsigned short * biggishint_internal_addsubtract(unsigned short * bi1, unsigned short * bi2, int flipsign2);
+unsigned int     biggishint_internal_addwords(unsigned short * result, unsigned short * w1, unsigned short * w2, unsigned int wordcount, unsigned int carry);
+unsigned short * biggishint_internal_alloc(unsigned long wordcount);
 int              biggishint_internal_bitsize(unsigned long);
+unsigned short * biggishint_internal_bitwise(unsigned short * bi1, unsigned short * bi2, char op);
 unsigned short * biggishint_internal_clone(unsigned short * bi1);
 int              biggishint_internal_comparemagnitude(unsigned short * bi1, unsigned short * bi2);
-unsigned short * biggishint_internal_shiftleft(unsigned short * bi1, unsigned int bitcount);
-unsigned short * biggishint_internal_shiftright(unsigned short * bi1, unsigned int bitcount);
+int              biggishint_internal_comparewords(unsigned short * w1, unsigned short * w2, unsigned int wordcount);
+void             biggishint_internal_free(unsigned short * bi1);
+unsigned short * biggishint_internal_fromdigits(biggishint_internal_digit * digits, int digitcount);
+unsigned long    biggishint_internal_magnitude(unsigned short * bi1);
+void             biggishint_internal_montgomerymultiply(biggishint_internal_digit * result, biggishint_internal_digit * a, biggishint_internal_digit * b, biggishint_internal_digit * modulus, biggishint_internal_digit minverse, int digitcount, biggishint_internal_digit * scratch);
+int              biggishint_internal_multiplythreads(unsigned short * result, unsigned short * w1, unsigned long words1, unsigned short * w2, unsigned long words2);
+void             biggishint_internal_multiplywords(unsigned short * result, unsigned short * w1, unsigned long words1, unsigned short * w2, unsigned long words2);
+unsigned short * biggishint_internal_resize(unsigned short * bi1, unsigned long wordcount);
+void             biggishint_internal_selectkernels(int portable);
+unsigned short * biggishint_internal_shiftleft(unsigned short * bi1, unsigned long bitcount);
+unsigned short * biggishint_internal_shiftright(unsigned short * bi1, unsigned long bitcount);
+void             biggishint_internal_shiftrightwords(unsigned short * words, unsigned long wordcount, unsigned long bitcount);
 void             biggishint_internal_shortdivide(unsigned short * bi1, unsigned short * i2);
 void             biggishint_internal_shortmultiply(unsigned short ** bi1, unsigned short i2);
+unsigned int     biggishint_internal_subtractwords(unsigned short * result, unsigned short * w1, unsigned short * w2, unsigned int wordcount, unsigned int borrow);
+void             biggishint_internal_todigits(unsigned short * bi1, biggishint_internal_digit * digits, int digitcount);
+char           * biggishint_internal_tostringbatch(unsigned short ** bis, int count, char * (* convert)(unsigned short *));
+unsigned long    biggishint_internal_trailingzeros(unsigned short * words, unsigned long wordcount);
 unsigned short * biggishint_internal_trim(unsigned short ** bi1);
 
+/* The kernels that add, subtract and compare runs of words.  Each one */
+/* works on arrays in biggishint (big endian) word order, the last */
+/* word being the least significant.  Set by selectkernels. */
+static unsigned int (* biggishint_kernel_add)(unsigned short *, unsigned short *, unsigned short *, unsigned int, unsigned int);
+static unsigned int (* biggishint_kernel_subtract)(unsigned short *, unsigned short *, unsigned short *, unsigned int, unsigned int);
+static int          (* biggishint_kernel_compare)(unsigned short *, unsigned short *, unsigned int);
+static const char *    biggishint_kernel_names = NULL;
+
+#ifndef BIGGISHINT_NO_POOL
+/* Free lists for the pooled size classes: class 1 holds 2 word (4 */
+/* byte) biggishints and class 2 holds 4 word (8 byte) ones.  A free */
+/* slot stores the pointer to the next free slot in its own memory, */
+/* so slots are never smaller than a pointer. */
+#define BIGGISHINT_POOL_CLASSES   3     /* index 0 is unused */
+#define BIGGISHINT_POOL_MAXFREE 256     /* per class, per thread */
+#define BIGGISHINT_POOL_CLASS(wordcount) \
+    ((wordcount) == 2 ? 1 : (wordcount) == 4 ? 2 : 0)
+#define BIGGISHINT_POOL_SLOTBYTES(wordcount) \
+    ((wordcount) * sizeof(short) > sizeof(void *) \
+        ? (wordcount) * sizeof(short) : sizeof(void *))
+static BIGGISHINT_THREAD_LOCAL void * biggishint_pool_head[BIGGISHINT_POOL_CLASSES];
+static BIGGISHINT_THREAD_LOCAL int    biggishint_pool_count[BIGGISHINT_POOL_CLASSES];
+#endif
+
+#ifdef BIGGISHINT_THREADS
+/* The worker threads for biggishint_internal_multiplythreads.  They */
+/* are started when first needed and wait on biggishint_workers_wake */
+/* for tasks, which are blocks of rows of a long multiplication.  Only */
+/* one multiplication at a time uses them: whoever holds the busy */
+/* mutex.  Other threads meanwhile multiply on their own. */
+struct biggishint_internal_task {
+    unsigned short * result, * w1, * w2;
+    unsigned long    words1, words2;
+};
+static pthread_mutex_t biggishint_workers_busy  = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t biggishint_workers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  biggishint_workers_wake  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  biggishint_workers_done  = PTHREAD_COND_INITIALIZER;
+static pthread_t       biggishint_workers[BIGGISHINT_MAXTHREADS];
+static int             biggishint_workers_count   = 0;  /* started */
+static int             biggishint_workers_threads = 0;  /* to use, 0 for default */
+static int             biggishint_workers_exit    = 0;
+static struct biggishint_internal_task * biggishint_workers_tasks;
+static int             biggishint_workers_next, biggishint_workers_taskcount;
+static int             biggishint_workers_unfinished;
+static void            biggishint_internal_stopworkers(void);
+static void          * biggishint_internal_worker(void * unused);
+#endif
+
 
 /* --------------------------- Functions ---------------------------- */
 
@@ -94,6 +259,54 @@ biggishintAdd(unsigned short * bi1, unsigned short * bi2)
 }
 
 
+/* biggishintAllocations */
+/* Returns how many times the calling thread has allocated heap memory */
+/* (malloc, calloc or realloc) in biggishint functions.  Blocks reused */
+/* from the free lists are not counted.  For benchmarks. */
+unsigned long
+biggishintAllocations(void)
+{
+    return biggishint_allocations;
+}
+
+
+/* biggishintBitwiseAnd */
+/* The bitwise functions treat negative numbers as if they were stored */
+/* in two's complement with infinitely many leading 1 bits, like */
+/* Perl 6 does, so for example -1 +& x == x and -6 +| 3 == -5. */
+unsigned short *
+biggishintBitwiseAnd(unsigned short * bi1, unsigned short * bi2)
+{
+    return biggishint_internal_bitwise(bi1, bi2, '&');
+}
+
+
+/* biggishintBitwiseNot */
+/* ~x == -1 - x in two's complement, which needs no bit twiddling. */
+unsigned short *
+biggishintBitwiseNot(unsigned short * bi1)
+{
+    unsigned short minusone[2] = {5,1};
+    return biggishint_internal_addsubtract(minusone, bi1, 1);
+}
+
+
+/* biggishintBitwiseOr */
+unsigned short *
+biggishintBitwiseOr(unsigned short * bi1, unsigned short * bi2)
+{
+    return biggishint_internal_bitwise(bi1, bi2, '|');
+}
+
+
+/* biggishintBitwiseXor */
+unsigned short *
+biggishintBitwiseXor(unsigned short * bi1, unsigned short * bi2)
+{
+    return biggishint_internal_bitwise(bi1, bi2, '^');
+}
+
+
 /* biggishintCompare */
 int
 biggishintCompare(unsigned short * bi1, unsigned short * bi2)
@@ -120,21 +333,22 @@ biggishintDivide(unsigned short * bi1, unsigned short * divisor)
     /* In contast with most of the other routines, this one uses */
     /* multiple returns to avoid having many levels of nested */
     /* conditionals. */
-    unsigned short   bi1size, divisorsize, dividendword1, dividendword2;
+    unsigned long    bi1size, divisorsize;
+    unsigned short   dividendword1, dividendword2;
     unsigned short * dividend, * pdividend, * pdividendhi, * pdividendlo;
     unsigned short * quotient, * pquotient, * pquotienthi, * pquotientlo;
     unsigned short * pdivisor, * pdivisorhi, * pdivisorlo;
     int sign1, sign2, sign, comparison, divisorshift;
     unsigned long dividendcarry, trialdivisor;
     unsigned long tempquotient, trialquotientmin, quotientcarry;
-    bi1size     = (* bi1 & 0xfffc) >> 1;
-    divisorsize = (* divisor & 0xfffc) >> 1;
+    bi1size     = BIGGISHINT_SIZE(bi1);
+    divisorsize = BIGGISHINT_SIZE(divisor);
     sign1 = * bi1 & 1;
     sign2 = * divisor & 1;
     sign  = sign1 ^ sign2;
     /* Does dividend have fewer words than divisor? */
     if (bi1size < divisorsize) {  /* quotient becomes 0 */
-        quotient = (unsigned short *) calloc(2, sizeof(short));
+        quotient = biggishint_internal_alloc(2);
         * quotient = 4;
         return quotient;
     }
@@ -152,13 +366,13 @@ biggishintDivide(unsigned short * bi1, unsigned short * divisor)
         /* Hope the C compiler merges this code with the same code in */
         /* (bi1size < bi2size) above.  Repeated here because the */
         /* earlier case avoids the comparemagnitude function. */
-        quotient = (unsigned short *) calloc(2, sizeof(short));
+        quotient = biggishint_internal_alloc(2);
         * quotient = 4;
         return quotient;
     }
     /* Is dividend equal in magnitude to divisor? */
     if (comparison==0) {  /* quotient becomes 1 (+ or -) */
-        quotient = (unsigned short *) calloc(2, sizeof(short));
+        quotient = biggishint_internal_alloc(2);
         * quotient = 4 | sign;
         quotient[1] = 1;
         return quotient;
@@ -198,8 +412,8 @@ biggishintDivide(unsigned short * bi1, unsigned short * divisor)
             divisor, pdivisorhi-divisor, pdivisorlo-divisor);
     #endif
     /* Initialize the quotient (result)  */
-    quotient = (unsigned short *) calloc(bi1size, sizeof(short));
-    * quotient = bi1size << 1 | sign;
+    quotient = biggishint_internal_alloc(bi1size);
+    * quotient = BIGGISHINT_HEADER(bi1size) | sign;
     /* Work out at which word in quotient the result will begin */
     pquotienthi = quotient + (bi1[1] ? 1 : 2) + (pdivisorlo-pdivisorhi);
     pquotientlo = quotient + bi1size - 1;
@@ -355,7 +569,7 @@ biggishintDivide(unsigned short * bi1, unsigned short * divisor)
         dividendcarry >>= 16;
     }
 
-    free(dividend);
+    biggishint_internal_free(dividend);
     return biggishint_internal_trim(&quotient);
 }
 
@@ -364,38 +578,109 @@ biggishintDivide(unsigned short * bi1, unsigned short * divisor)
 void
 biggishintFree(unsigned short * bi1)
 {
-    free(bi1);
+    biggishint_internal_free(bi1);
+}
+
+
+/* biggishintFreeBatch */
+void
+biggishintFreeBatch(unsigned short ** bis, int count)
+{
+    int i;
+    for (i=0; i<count; ++i)
+        biggishint_internal_free(bis[i]);
+}
+
+
+/* biggishintFromBytes */
+/* Makes a biggishint from bytecount bytes of magnitude, least */
+/* significant byte first, negative if negative is nonzero.  Nothing */
+/* is parsed, so this is the quick way in from a Perl 6 Buf. */
+unsigned short *
+biggishintFromBytes(unsigned char * bytes, long bytecount, int negative)
+{
+    unsigned long datawords, size, i;
+    unsigned short * bi1;
+    datawords = ((unsigned long) bytecount + 1) >> 1;
+    size = (datawords + 2) & ~1UL;  /* word 0 and an even total */
+    bi1 = biggishint_internal_alloc(size);
+    * bi1 = BIGGISHINT_HEADER(size) | (negative != 0);
+    for (i=0; i+1<(unsigned long) bytecount; i+=2)
+        bi1[size-1-(i>>1)] = bytes[i] | (bytes[i+1] << 8);
+    if (bytecount & 1)  /* the last byte has a word to itself */
+        bi1[size-1-(i>>1)] = bytes[i];
+    return bi1;
 }
 
 
 /* biggishintFromDecimalString */
-/* Note: this algorithm is unacceptably inefficient and should be */
-/* rewritten, because the two other biggishint functions it calls */
-/* cause two malloc() calls per decimal digit. */
+/* Converts BIGGISHINT_DECIMAL_DIGITS digits at a time, multiplying */
+/* the result so far by a power of ten and adding them in place.  The */
+/* result is allocated once, with room for 1/4 word per digit, which */
+/* is more than log2(10)/16.  Only the words in use are multiplied. */
 unsigned short *
 biggishintFromDecimalString(char * str)
 {
-    char * ps, c;
-    int sign = 0;
-    unsigned short * bi1, * bi2;
-    unsigned short digitvalue[2] = {4,0};
+    char * ps;
+    int sign = 0, chunkdigits;
+    unsigned long digitcount, resultsize;
+    unsigned short * bi1, * pfirst, * p1, * pend;
+    biggishint_internal_doubledigit carry, multiplier;
     ps = str;
     if (* ps == '-') { /* Detect a leading minus sign */
         sign = 1;
         ++ps;
     }
-    /* Create the initial biggishint result with a value of 0 */
-    bi1 = (unsigned short *) calloc(2,2);
-    * bi1 = 4 | sign;
-    /* take one digit at a time, convert to binary, accumulate values */
-    while ( isdigit(c = * ps++) ) {
-        biggishint_internal_shortmultiply(&bi1, 10);
-        digitvalue[1] = c - '0';
-        bi2 = biggishint_internal_addsubtract(bi1, digitvalue, 0);
-        free(bi1);
-        bi1 = bi2;
+    for (digitcount=0; isdigit(ps[digitcount]); ++digitcount)
+        ;
+    resultsize = (digitcount / 4 + 3) & ~1UL;
+    bi1 = biggishint_internal_alloc(resultsize);
+    * bi1 = BIGGISHINT_HEADER(resultsize);
+    pend   = bi1 + resultsize;
+    pfirst = pend;  /* the words in use are pfirst to pend-1 */
+    while (digitcount) {
+        /* The first chunk takes the odd digits, the rest are whole */
+        chunkdigits = (digitcount - 1) % BIGGISHINT_DECIMAL_DIGITS + 1;
+        digitcount -= chunkdigits;
+        carry = 0;
+        multiplier = 1;
+        while (chunkdigits--) {
+            carry = carry * 10 + (* ps++ - '0');
+            multiplier *= 10;
+        }
+        for (p1=pend; p1>pfirst; ) {
+            carry += * --p1 * multiplier;
+            * p1 = (unsigned short) carry;
+            carry >>= 16;
+        }
+        while (carry) {
+            * --pfirst = (unsigned short) carry;
+            carry >>= 16;
+        }
     }
-    return bi1;
+    * bi1 |= sign;
+    return biggishint_internal_trim(&bi1);
+}
+
+
+/* biggishintFromDecimalStringBatch */
+/* Converts up to count decimal numbers, separated by white space, */
+/* from str into results.  Returns how many it found. */
+int
+biggishintFromDecimalStringBatch(unsigned short ** results, char * str, int count)
+{
+    char * ps = str;
+    int i;
+    for (i=0; i<count; ++i) {
+        while (isspace((unsigned char) * ps))
+            ++ps;
+        if (! isdigit((unsigned char) * ps) && ! (* ps == '-' && isdigit((unsigned char) ps[1])))
+            break;
+        results[i] = biggishintFromDecimalString(ps);
+        for (++ps; isdigit((unsigned char) * ps); ++ps)
+            ;
+    }
+    return i;
 }
 
 
@@ -403,8 +688,10 @@ biggishintFromDecimalString(char * str)
 unsigned short *
 biggishintFromHexadecimalString(char * str)
 {
-    int hexdigitcount, biggishintwordcount, i, nybble, sign=0;
-    unsigned short biggishintarraysize, * biggishint, * shortPointer, value;
+    long hexdigitcount, i;
+    int nybble, sign=0;
+    unsigned long biggishintwordcount, biggishintarraysize;
+    unsigned short * biggishint, * shortPointer, value;
     char character, * strPointer;
 
     strPointer = str;
@@ -418,10 +705,10 @@ biggishintFromHexadecimalString(char * str)
     /* The number of short integers holding values must always be odd */
     biggishintwordcount = (((hexdigitcount+3)>>3)<<1)+1; /* 1-4=>1, 5-12=>3 etc */
     biggishintarraysize = biggishintwordcount + 1;
-    biggishint = (unsigned short *) calloc(biggishintarraysize, sizeof(unsigned short));
+    biggishint = biggishint_internal_alloc(biggishintarraysize);
     assert( biggishint != NULL );
     shortPointer = biggishint;
-    * shortPointer++ = (biggishintarraysize << 1) | sign;
+    * shortPointer++ = BIGGISHINT_HEADER(biggishintarraysize) | sign;
     /* leave one word blank for 5-8 13-16 21-24 digit strings */
     if ( (hexdigitcount-1) & 0x4) ++shortPointer;
     value = 0;
@@ -448,12 +735,12 @@ biggishintFromLong(long l)
         l = -l;
     }
     if (l <= USHRT_MAX) {
-        bi1 = (unsigned short *) calloc(2,sizeof(short));
+        bi1 = biggishint_internal_alloc(2);
         * bi1 = 4 | negative_bit;
         bi1[1] = (unsigned short) l;
     }
     else {
-        bi1 = (unsigned short *) calloc(4,sizeof(short));
+        bi1 = biggishint_internal_alloc(4);
         * bi1 = 8 | negative_bit;
         bi1[3] = (unsigned short) l;
         bi1[2] = l >> 16;
@@ -462,22 +749,112 @@ biggishintFromLong(long l)
 }
 
 
+/* biggishintGreatestCommonDivisor */
+/* The binary (Stein's) algorithm, which needs only shifts and */
+/* subtractions.  It works in place on copies of the two magnitudes, */
+/* and only on the words still in use as they shrink.  The result is */
+/* never negative, and the greatest common divisor of 0 and 0 is 0. */
+unsigned short *
+biggishintGreatestCommonDivisor(unsigned short * bi1, unsigned short * bi2)
+{
+    unsigned long size, size1, size2, words, used, zeros1, zeros2;
+    unsigned short * u, * v, * swap, * result;
+    int comparison;
+    if (biggishint_kernel_add == NULL)
+        biggishint_internal_selectkernels(0);
+    size1 = BIGGISHINT_SIZE(bi1);
+    size2 = BIGGISHINT_SIZE(bi2);
+    size  = size1 > size2 ? size1 : size2;
+    words = size - 1;
+    u = biggishint_internal_alloc(size);
+    v = biggishint_internal_alloc(size);
+    * u = * v = BIGGISHINT_HEADER(size);
+    memcpy(u + size - (size1 - 1), bi1 + 1, (size1 - 1) * sizeof(short));
+    memcpy(v + size - (size2 - 1), bi2 + 1, (size2 - 1) * sizeof(short));
+    zeros1 = biggishint_internal_trailingzeros(u + 1, words);
+    zeros2 = biggishint_internal_trailingzeros(v + 1, words);
+    /* gcd(0, v) is v and gcd(u, 0) is u */
+    if (zeros1 == words << 4 || zeros2 == words << 4) {
+        if (zeros1 == words << 4) { swap = u; u = v; v = swap; }
+        biggishint_internal_free(v);
+        return biggishint_internal_trim(&u);
+    }
+    /* Take out the common factors of 2, which go back in at the end */
+    biggishint_internal_shiftrightwords(u + 1, words, zeros1);
+    biggishint_internal_shiftrightwords(v + 1, words, zeros2);
+    used = words;
+    for (;;) {  /* u and v are both odd here */
+        while (used > 1 && u[size-used] == 0 && v[size-used] == 0)
+            --used;
+        comparison = biggishint_kernel_compare(u + size - used, v + size - used, (unsigned int) used);
+        if (comparison == 0)
+            break;
+        if (comparison > 0) { swap = u; u = v; v = swap; }
+        /* v = (v - u) with its factors of 2 removed, so still odd */
+        biggishint_kernel_subtract(v + size - used, v + size - used, u + size - used, (unsigned int) used, 0);
+        biggishint_internal_shiftrightwords(v + size - used, used,
+            biggishint_internal_trailingzeros(v + size - used, used));
+    }
+    biggishint_internal_free(v);
+    zeros1 = zeros1 < zeros2 ? zeros1 : zeros2;
+    if (zeros1) {
+        result = biggishint_internal_shiftleft(u, zeros1);
+        biggishint_internal_free(u);
+        u = result;
+    }
+    return biggishint_internal_trim(&u);
+}
+
+
+/* biggishintKernels */
+/* Reports which add/subtract/compare kernels are in use, for example */
+/* "adx+avx2" or "portable".  Passing "portable" switches to the */
+/* portable C kernels, passing "auto" goes back to the fastest ones the */
+/* processor supports, and NULL changes nothing.  Meant for */
+/* benchmarking and testing. */
+const char *
+biggishintKernels(char * name)
+{
+    if (name)
+        biggishint_internal_selectkernels(strcmp(name, "portable") == 0);
+    else if (biggishint_kernel_names == NULL)
+        biggishint_internal_selectkernels(0);
+    return biggishint_kernel_names;
+}
+
+
+/* biggishintModulo */
+/* The remainder that goes with biggishintDivide, which truncates */
+/* towards zero, so the remainder has the sign of the dividend (like */
+/* the C % operator). */
+unsigned short *
+biggishintModulo(unsigned short * bi1, unsigned short * bi2)
+{
+    unsigned short * quotient, * product, * remainder;
+    quotient  = biggishintDivide(bi1, bi2);
+    product   = biggishintMultiply(quotient, bi2);
+    remainder = biggishint_internal_addsubtract(bi1, product, 1);
+    biggishint_internal_free(quotient);
+    biggishint_internal_free(product);
+    return remainder;
+}
+
+
 /* biggishintMultiply */
 unsigned short *
 biggishintMultiply(unsigned short * bi1, unsigned short * bi2)
 {
-    unsigned short bi1size, bi2size, res1size, res2size, sign1, sign2;
-    unsigned short * p1, * p2, * result, * presult;
-    int i1, i2;
-    unsigned long resultsize, n1, n2, subtotal, carry;
+    unsigned short sign1, sign2;
+    unsigned short * p1, * p2, * result, * ptemp;
+    unsigned long bi1size, bi2size, words1, words2, resultsize, wordstemp;
 
     /* Before starting on the main long multiplication, which is */
     /* slow, try to identify multipliers that offer an opportunity */
     /* for a shortcut, for example by 0 or 1, shifting left for */
     /* multipliers that are multiples of powers of two, or short */
     /* multiplication. */
-    bi1size = (* bi1 & 0xfffc) >> 1;
-    bi2size = (* bi2 & 0xfffc) >> 1;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    bi2size = BIGGISHINT_SIZE(bi2);
     if (bi1size == 2) {
         result = biggishint_internal_clone(bi2);
         * result &= 0xfffe;  /* clear the sign bit */
@@ -490,34 +867,24 @@ biggishintMultiply(unsigned short * bi1, unsigned short * bi2)
             biggishint_internal_shortmultiply(&result, bi2[1]);
         }
         else { /* both bi1 and bi2 are more than 16 bit numbers */
-            /* Create a result array that is large enough for any */
-            /* possible product.  First calculate the smallest size */
-            /* according to the contents of bi1 and bi2, regardless */
-            /* of the need to round up to an even number. */ 
-            res1size = bi1size + (bi1[1] ? 0 : -1); /* the first word may be 0 */
-            res2size = bi2size + (bi2[1] ? 0 : -1);
-            /* Then add them together and round to an even number */
-            resultsize  = (res1size + res2size + 1) & 0xfffe;
-            result = (unsigned short *) calloc(resultsize, sizeof(short));
-            * result = (resultsize << 1);
-            presult = result + resultsize;
-            p1 = bi1 + bi1size;
-            for (i1=1; i1<bi1size; ++i1) {
-                n1 = * --p1;
-                presult = result + resultsize - i1;
-                p2 = bi2 + bi2size;
-                carry = 0;
-                for (i2=1; i2<bi2size; ++i2) {
-                    n2 = * --p2;
-                    subtotal = (* presult) + n1 * n2 + carry;
-                    carry = subtotal >> 16;
-                    * presult-- = subtotal & 0xffff;
-                }
-                while (carry) {
-                    * presult-- = carry;
-                    carry >>= 16;
-                }
+            /* Leave out the leading zero words, then create a result */
+            /* array that is large enough for any possible product, */
+            /* rounded up to an even number of words. */
+            p1 = bi1 + 1;  words1 = bi1size - 1;
+            p2 = bi2 + 1;  words2 = bi2size - 1;
+            for ( ; words1 > 1 && * p1 == 0; --words1) ++p1;
+            for ( ; words2 > 1 && * p2 == 0; --words2) ++p2;
+            /* The rows of the longer number are split between threads */
+            if (words1 < words2) {
+                ptemp = p1;  p1 = p2;  p2 = ptemp;
+                wordstemp = words1;  words1 = words2;  words2 = wordstemp;
             }
+            resultsize = (words1 + words2 + 2) & ~1UL;
+            result = biggishint_internal_alloc(resultsize);
+            * result = BIGGISHINT_HEADER(resultsize);
+            ptemp = result + resultsize - words1 - words2;
+            if (! biggishint_internal_multiplythreads(ptemp, p1, words1, p2, words2))
+                biggishint_internal_multiplywords(ptemp, p1, words1, p2, words2);
         }
     }
     sign1 = * bi1 & 1;
@@ -527,18 +894,266 @@ biggishintMultiply(unsigned short * bi1, unsigned short * bi2)
 }
 
 
+/* biggishintMultiplyBatch */
+/* results[i] = bis1[i] * bis2[i] for i from 0 to count-1.  To scale */
+/* every number by the same factor, fill bis2 with the same pointer. */
+void
+biggishintMultiplyBatch(unsigned short ** results, unsigned short ** bis1,
+    unsigned short ** bis2, int count)
+{
+    int i;
+    for (i=0; i<count; ++i)
+        results[i] = biggishintMultiply(bis1[i], bis2[i]);
+}
+
+
+/* biggishintPower */
+/* Binary exponentiation, scanning the exponent from the top bit down. */
+/* A negative exponent gives the integer part of 1/(bi1**-bi2), which */
+/* is 0 unless bi1 is 1 or -1. */
+unsigned short *
+biggishintPower(unsigned short * bi1, unsigned short * bi2)
+{
+    unsigned short * result, * temp, word;
+    unsigned long bi2size, i;
+    int bit, started;
+    bi2size = BIGGISHINT_SIZE(bi2);
+    if (* bi2 & 1) {
+        result = biggishint_internal_alloc(2);
+        * result = 4;
+        if (biggishint_internal_magnitude(bi1) == 1) {
+            /* (-1)**-n is -1 for odd n */
+            result[1] = 1;
+            * result |= (* bi1 & 1) & bi2[bi2size-1];
+        }
+        return result;
+    }
+    result = biggishint_internal_alloc(2);
+    * result = 4;
+    result[1] = 1;
+    started = 0;  /* no point squaring 1 for the leading 0 bits */
+    for (i=1; i<bi2size; ++i) {
+        word = bi2[i];
+        for (bit=15; bit>=0; --bit) {
+            if (started) {
+                temp = biggishintMultiply(result, result);
+                biggishint_internal_free(result);
+                result = temp;
+            }
+            if ((word >> bit) & 1) {
+                started = 1;
+                temp = biggishintMultiply(result, bi1);
+                biggishint_internal_free(result);
+                result = temp;
+            }
+        }
+    }
+    return result;
+}
+
+
+/* biggishintPowerModulo */
+/* Calculates (bi1 ** bi2) mod bi3 without ever making the full power. */
+/* The result is always from 0 to abs(bi3)-1.  Returns NULL if bi3 is */
+/* 0 or bi2 is negative.  An odd modulus (the usual case, for example */
+/* in RSA) uses Montgomery multiplication with a sliding window over */
+/* the exponent bits, which avoids long division completely.  An even */
+/* modulus falls back to multiplying and dividing. */
+unsigned short *
+biggishintPowerModulo(unsigned short * bi1, unsigned short * bi2, unsigned short * bi3)
+{
+    unsigned short * modulus, * base, * temp, * result;
+    unsigned short shortone[2] = {4,1};
+    unsigned long bi2size, bi3size;
+    biggishint_internal_digit * m, * table, * x, * y, * scratch, minverse;
+    long i, j, k, bits, top;
+    int n, window, value, started;
+    bi2size = BIGGISHINT_SIZE(bi2);
+    bi3size = BIGGISHINT_SIZE(bi3);
+    if ((* bi2 & 1) || biggishint_internal_magnitude(bi3) == 0)
+        return NULL;
+    modulus = biggishint_internal_clone(bi3);
+    * modulus &= 0xfffe;  /* clear the sign bit */
+    /* Reduce the base to 0..modulus-1 first */
+    base = biggishintModulo(bi1, modulus);
+    if (* base & 1) {
+        temp = biggishint_internal_addsubtract(base, modulus, 0);
+        biggishint_internal_free(base);
+        base = temp;
+    }
+    bits = ((bi2size - 1) << 4);  /* exponent bits, including leading 0s */
+    #define BIGGISHINT_EXPONENTBIT(i) \
+        ((bi2[bi2size - 1 - ((i) >> 4)] >> ((i) & 0xf)) & 1)
+
+    if ((bi3[bi3size-1] & 1) == 0) {
+        /* Even modulus: left to right square and multiply, from the */
+        /* highest set bit of the exponent down */
+        for (top=bits-1; top>=0 && ! BIGGISHINT_EXPONENTBIT(top); --top)
+            ;
+        result = biggishint_internal_clone(top < 0 ? shortone : base);
+        for (i=top-1; i>=0; --i) {
+            temp = biggishintMultiply(result, result);
+            biggishint_internal_free(result);
+            result = biggishintModulo(temp, modulus);
+            biggishint_internal_free(temp);
+            if (BIGGISHINT_EXPONENTBIT(i)) {
+                temp = biggishintMultiply(result, base);
+                biggishint_internal_free(result);
+                result = biggishintModulo(temp, modulus);
+                biggishint_internal_free(temp);
+            }
+        }
+        temp = biggishintModulo(result, modulus);  /* for modulus 1 */
+        biggishint_internal_free(result);
+        biggishint_internal_free(base);
+        biggishint_internal_free(modulus);
+        return temp;
+    }
+
+    /* Odd modulus: Montgomery form, with R = 2**(n*BIGGISHINT_DIGIT_BITS) */
+    n = ((bi3size - 1) + BIGGISHINT_DIGIT_WORDS - 1) / BIGGISHINT_DIGIT_WORDS;
+    /* Choose the window size from the exponent size */
+    window = bits > 1024 ? 6 : bits > 256 ? 5 : bits > 64 ? 4 : bits > 16 ? 3 : 2;
+    m       = (biggishint_internal_digit *) malloc(
+                  ((5 + (1 << (window - 1))) * n + 2) * sizeof(biggishint_internal_digit));
+    ++biggishint_allocations;
+    assert( m != NULL );
+    x       = m + n;
+    y       = x + n;
+    scratch = y + n;   /* n + 2 digits */
+    table   = scratch + n + 2;  /* odd powers base**1, **3, **5 ... */
+    biggishint_internal_todigits(modulus, m, n);
+    /* minverse = -1/m mod 2**BIGGISHINT_DIGIT_BITS by Newton iteration, */
+    /* each step doubles the number of correct low bits.  The products */
+    /* are unsigned double digits, as 16-bit digits would be promoted */
+    /* to int and could overflow it. */
+    minverse = m[0];
+    for (i=0; i<5; ++i)
+        minverse = (biggishint_internal_digit) ((biggishint_internal_doubledigit) minverse
+            * (2 - (biggishint_internal_doubledigit) m[0] * minverse));
+    minverse = (biggishint_internal_digit) (0 - (biggishint_internal_doubledigit) minverse);
+    /* x = R**2 mod m converts into Montgomery form: mont(a, R**2) = aR */
+    temp = biggishint_internal_shiftleft(shortone, 2 * n * BIGGISHINT_DIGIT_BITS);
+    result = biggishintModulo(temp, modulus);
+    biggishint_internal_free(temp);
+    biggishint_internal_todigits(result, x, n);
+    biggishint_internal_free(result);
+    biggishint_internal_todigits(base, y, n);
+    biggishint_internal_montgomerymultiply(table, y, x, m, minverse, n, scratch);
+    /* y = base**2, then the table of odd powers */
+    biggishint_internal_montgomerymultiply(y, table, table, m, minverse, n, scratch);
+    for (i=1; i < (1 << (window - 1)); ++i)
+        biggishint_internal_montgomerymultiply(table + i * n, table + (i-1) * n,
+            y, m, minverse, n, scratch);
+    /* x = 1 in Montgomery form, which is R mod m = mont(1, R**2) */
+    memset(y, 0, n * sizeof(biggishint_internal_digit));
+    y[0] = 1;
+    biggishint_internal_montgomerymultiply(y, y, x, m, minverse, n, scratch);
+    memcpy(x, y, n * sizeof(biggishint_internal_digit));
+    /* Scan the exponent from the top bit, taking up to window bits */
+    /* at a time that start and end with a 1 bit */
+    started = 0;
+    for (i=bits-1; i>=0; ) {
+        if (! BIGGISHINT_EXPONENTBIT(i)) {
+            if (started)
+                biggishint_internal_montgomerymultiply(x, x, x, m, minverse, n, scratch);
+            --i;
+            continue;
+        }
+        j = i - window + 1;
+        if (j < 0) j = 0;
+        while (! BIGGISHINT_EXPONENTBIT(j))
+            ++j;
+        value = 0;
+        for (k=i; k>=j; --k) {
+            value = (value << 1) | BIGGISHINT_EXPONENTBIT(k);
+            if (started)
+                biggishint_internal_montgomerymultiply(x, x, x, m, minverse, n, scratch);
+        }
+        if (started)
+            biggishint_internal_montgomerymultiply(x, x, table + (value >> 1) * n,
+                m, minverse, n, scratch);
+        else
+            memcpy(x, table + (value >> 1) * n, n * sizeof(biggishint_internal_digit));
+        started = 1;
+        i = j - 1;
+    }
+    #undef BIGGISHINT_EXPONENTBIT
+    /* Convert back out of Montgomery form: mont(xR, 1) = x */
+    memset(y, 0, n * sizeof(biggishint_internal_digit));
+    y[0] = 1;
+    biggishint_internal_montgomerymultiply(x, x, y, m, minverse, n, scratch);
+    result = biggishint_internal_fromdigits(x, n);
+    free(m);
+    biggishint_internal_free(base);
+    biggishint_internal_free(modulus);
+    return result;
+}
+
+
+/* biggishintReleaseCache */
+/* Return the blocks on the calling thread's free lists to the heap. */
+/* Call it before a thread that used biggishints exits, otherwise the */
+/* blocks it cached are lost. */
+void
+biggishintReleaseCache(void)
+{
+#ifndef BIGGISHINT_NO_POOL
+    int sizeclass;
+    void * slot;
+    for (sizeclass=1; sizeclass<BIGGISHINT_POOL_CLASSES; ++sizeclass) {
+        while ((slot = biggishint_pool_head[sizeclass]) != NULL) {
+            biggishint_pool_head[sizeclass] = * (void **) slot;
+            free(slot);
+        }
+        biggishint_pool_count[sizeclass] = 0;
+    }
+#endif
+}
+
+
 /* biggishintShiftLeft */
+/* A negative shift count shifts right instead. */
 unsigned short *
 biggishintShiftLeft(unsigned short * bi1, unsigned short * bi2)
-{   /* TODO: shift counts from 65536 to 524239 and -1 to -524239 bits */
-    return biggishint_internal_shiftleft(bi1, bi2[1]);
+{
+    unsigned short * result;
+    unsigned long bitcount;
+    bitcount = biggishint_internal_magnitude(bi2);
+    result = (* bi2 & 1)
+        ? biggishint_internal_shiftright(bi1, bitcount)
+        : biggishint_internal_shiftleft(bi1, bitcount);
+    return biggishint_internal_trim(&result);
 }
 
 
+/* biggishintShiftRight */
+/* Rounds towards minus infinity, so -5 shifted right by 1 is -3 just */
+/* like -5 +> 1 in Perl 6.  A negative shift count shifts left. */
 unsigned short *
 biggishintShiftRight(unsigned short * bi1, unsigned short * bi2)
 {
-    return NULL;
+    unsigned short * result;
+    unsigned long bitcount;
+    bitcount = biggishint_internal_magnitude(bi2);
+    result = (* bi2 & 1)
+        ? biggishint_internal_shiftleft(bi1, bitcount)
+        : biggishint_internal_shiftright(bi1, bitcount);
+    return biggishint_internal_trim(&result);
+}
+
+
+/* biggishintSign */
+/* Returns -1, 0 or 1 as bi1 is negative, zero or positive */
+int
+biggishintSign(unsigned short * bi1)
+{
+    unsigned long bi1size, i;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    for (i=1; i<bi1size; ++i)
+        if (bi1[i])
+            return (* bi1 & 1) ? -1 : 1;
+    return 0;
 }
 
 
@@ -550,55 +1165,182 @@ biggishintSubtract(unsigned short * bi1, unsigned short * bi2)
 }
 
 
+/* biggishintSumBatch */
+/* Adds up count biggishints.  The positive and negative ones are */
+/* added in place into one accumulator each, with room for the */
+/* carries of up to 2**32 numbers, and the two are subtracted at the */
+/* end.  So the sum needs three allocations however long the list. */
+unsigned short *
+biggishintSumBatch(unsigned short ** bis, int count)
+{
+    unsigned short * sums[2], * result, * p1, * bi1;
+    unsigned long maxwords = 1, words, sumsize;
+    unsigned int carry;
+    int i, sign;
+    if (biggishint_kernel_add == NULL)
+        biggishint_internal_selectkernels(0);
+    for (i=0; i<count; ++i) {
+        words = BIGGISHINT_SIZE(bis[i]) - 1;
+        if (words > maxwords)
+            maxwords = words;
+    }
+    sumsize = (maxwords + 4) & ~1UL;  /* at least 2 spare words */
+    for (sign=0; sign<2; ++sign) {
+        sums[sign] = biggishint_internal_alloc(sumsize);
+        * sums[sign] = BIGGISHINT_HEADER(sumsize) | sign;
+    }
+    for (i=0; i<count; ++i) {
+        bi1   = bis[i];
+        words = BIGGISHINT_SIZE(bi1) - 1;
+        p1    = sums[* bi1 & 1] + sumsize - words;
+        carry = biggishint_kernel_add(p1, p1, bi1 + 1, (unsigned int) words, 0);
+        while (carry)
+            carry = ++(* --p1) == 0;
+    }
+    result = biggishint_internal_addsubtract(sums[0], sums[1], 0);
+    biggishint_internal_free(sums[0]);
+    biggishint_internal_free(sums[1]);
+    return result;
+}
+
+
+/* biggishintThreads */
+/* Sets how many threads, including the calling one, share the work */
+/* of multiplying large numbers, if threads is more than 0.  Returns */
+/* the number in use, by default the number of processors online, or */
+/* always 1 if the library was compiled without BIGGISHINT_THREADS. */
+int
+biggishintThreads(int threads)
+{
+#ifdef BIGGISHINT_THREADS
+    pthread_mutex_lock(&biggishint_workers_busy);
+    if (threads > 0) {
+        if (threads > BIGGISHINT_MAXTHREADS)
+            threads = BIGGISHINT_MAXTHREADS;
+        if (biggishint_workers_count > threads - 1)
+            biggishint_internal_stopworkers();
+        biggishint_workers_threads = threads;
+    }
+    if (biggishint_workers_threads == 0) {
+        threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        biggishint_workers_threads = threads < 1 ? 1
+            : threads > BIGGISHINT_MAXTHREADS ? BIGGISHINT_MAXTHREADS : threads;
+    }
+    threads = biggishint_workers_threads;
+    pthread_mutex_unlock(&biggishint_workers_busy);
+    return threads;
+#else
+    (void) threads;
+    return 1;
+#endif
+}
+
+
+/* biggishintToBytes */
+/* Writes the magnitude of bi1 into bytes, least significant byte */
+/* first, and returns how many bytes that takes (1 for zero).  Nothing */
+/* is written if bytecount is less than that, so a call with a */
+/* bytecount of 0 finds out how big a buffer to pass.  The sign is */
+/* left out, see biggishintSign. */
+long
+biggishintToBytes(unsigned short * bi1, unsigned char * bytes, long bytecount)
+{
+    unsigned long bi1size, top, i;
+    long needed, j;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    /* Find the most significant nonzero word, or the last one */
+    for (top=1; top<bi1size-1 && bi1[top]==0; ++top)
+        ;
+    needed = (long) (bi1size - top) * 2 - (bi1[top] < 256);
+    if (bytecount < needed)
+        return needed;
+    for (i=bi1size-1, j=0; j<needed; --i, j+=2) {
+        bytes[j] = (unsigned char) bi1[i];
+        if (j+1 < needed)
+            bytes[j+1] = (unsigned char) (bi1[i] >> 8);
+    }
+    return needed;
+}
+
+
 /* biggishintToDecimalString */
+/* Divides a copy of the number by BIGGISHINT_DECIMAL_CHUNK repeatedly, */
+/* each remainder giving the next BIGGISHINT_DECIMAL_DIGITS digits from */
+/* the right.  The leading words are skipped as they become zero. */
 char *
 biggishintToDecimalString(unsigned short * bi1)
 {
     /* The number of decimal digits that will be created is difficult */
     /* (or slow) to calculate in advance.  This routine initially */
     /* over-allocates memory, and then sizes it correctly at the end. */
-    unsigned short bi1size, * bi2, digit, sign1;
-    int strsize, leadingzeroes;
+    unsigned short * bi2, * pfirst, * pend, * p2, sign1;
+    unsigned long bi1size, strsize, length;
+    biggishint_internal_doubledigit remainder;
+    int i;
     char * result, * pdigits, * p1;
     /* Calculate the very maximum number of characters that the */
     /* resulting string can occupy, including a terminating '\0'. */
     /* Each word is '65535' at most, then '\0' */
     bi2 = biggishint_internal_clone(bi1);
-    bi1size = (* bi1 & 0xfffc) >> 1;
+    bi1size = BIGGISHINT_SIZE(bi1);
     sign1 = * bi1 & 1;
     strsize = (bi1size-1) * 5 + sign1 + 1;
     result = (char *) malloc(strsize);
+    ++biggishint_allocations;
     assert( result != NULL );
     pdigits = result;
     if (sign1) * pdigits++ = '-';
     p1 = result + strsize;
     (* --p1) = '\0';
+    pfirst = bi2 + 1;
+    pend   = bi2 + bi1size;
     do {
-        digit = 10;
-        biggishint_internal_shortdivide(bi2, &digit);
-        (* --p1) = '0' + digit;
-    } while ( p1 > pdigits ); /* TODO: find other ways to finish early */
-    free(bi2);
-    /* Count how many '0' characters there are at the beginning of */
-    /* the string, and then move the non '0' characters. */
-    leadingzeroes = strspn(pdigits, "0");
-    if (leadingzeroes == strsize - sign1 - 1)
-        --leadingzeroes;
-    if (leadingzeroes) {
-        memmove(pdigits, pdigits+leadingzeroes, strsize-sign1-leadingzeroes); /* (Big Endian)-- ;) */
-        result = realloc(result, strsize-leadingzeroes);
+        while (pfirst < pend && * pfirst == 0)
+            ++pfirst;
+        remainder = 0;
+        for (p2=pfirst; p2<pend; ++p2) {
+            remainder = (remainder << 16) | * p2;
+            * p2 = (unsigned short) (remainder / BIGGISHINT_DECIMAL_CHUNK);
+            remainder %= BIGGISHINT_DECIMAL_CHUNK;
+        }
+        for (i=0; i<BIGGISHINT_DECIMAL_DIGITS && p1>pdigits; ++i) {
+            (* --p1) = '0' + (char) (remainder % 10);
+            remainder /= 10;
+        }
+    } while (pfirst < pend);
+    biggishint_internal_free(bi2);
+    /* The last chunk may have left '0' characters at the beginning, */
+    /* keep only one for the number 0 */
+    while (* p1 == '0' && p1[1])
+        ++p1;
+    if (p1 > pdigits) {
+        length = result + strsize - p1;  /* including the '\0' */
+        memmove(pdigits, p1, length); /* (Big Endian)-- ;) */
+        result = realloc(result, (pdigits - result) + length);
+        ++biggishint_allocations;
     }
     return result;
 }
 
 
+/* biggishintToDecimalStringBatch */
+/* Converts count biggishints to one string, a line per number with */
+/* no newline after the last. */
+char *
+biggishintToDecimalStringBatch(unsigned short ** bis, int count)
+{
+    return biggishint_internal_tostringbatch(bis, count, biggishintToDecimalString);
+}
+
+
 /* biggishintToHexadecimalString */
 char *
 biggishintToHexadecimalString(unsigned short * bi1)
 {
-    int bi1size, hexstringsize, i, j, value, nybble, emitzero, sign;
+    unsigned long bi1size, hexstringsize, i;
+    int j, value, nybble, emitzero, sign;
     char * hexString, * hexPointer;
-    bi1size = (* bi1 & 0xfffc) >> 1;
+    bi1size = BIGGISHINT_SIZE(bi1);
     sign = * bi1 & 1;
     /* Calculate how many characters the hex string needs, including */
     /* the "0x" at the beginning and a '\0' at the end */
@@ -606,6 +1348,7 @@ biggishintToHexadecimalString(unsigned short * bi1)
     hexstringsize += (hexstringsize?0:1) /* allow for 0 digit */
         + 3 + sign + ((bi1size-2) << 2); /* '0x' + sign + digits + '\0' */
     hexString = (char *) malloc(hexstringsize);
+    ++biggishint_allocations;
     assert( hexString != NULL );
     hexPointer = hexString;
     if (sign) * hexPointer++ = '-';
@@ -628,6 +1371,14 @@ biggishintToHexadecimalString(unsigned short * bi1)
 }
 
 
+/* biggishintToHexadecimalStringBatch */
+char *
+biggishintToHexadecimalStringBatch(unsigned short ** bis, int count)
+{
+    return biggishint_internal_tostringbatch(bis, count, biggishintToHexadecimalString);
+}
+
+
 /* ----------------------- Internal functions ----------------------- */
 /* Except for biggishint_internal_trim, the internal functions do not */
 /* trim their results, because it costs time, may be redundant, and */
@@ -638,10 +1389,11 @@ biggishintToHexadecimalString(unsigned short * bi1)
 unsigned short * biggishint_internal_addsubtract(unsigned short * bi1,
                                     unsigned short * bi2, int flipsign2)
 {
-    unsigned short bi1size, bi2size, res1size, res2size, resultsize;
+    unsigned long bi1size, bi2size, res1size, res2size, resultsize;
     unsigned short * result1, * result2, * larger, * smaller, * p1, * p2;
-    unsigned int sign1, sign2, sign, carry, i1, i2;
-    signed long partialresult;
+    unsigned int sign1, sign2, sign, carry, words1, words2, partialresult;
+    if (biggishint_kernel_add == NULL)
+        biggishint_internal_selectkernels(0);
     sign1 = * bi1 & 1;
     sign2 = (* bi2 & 1) ^ flipsign2;
     if (sign1 ^ sign2) {  /* different signs, do a subtract */
@@ -652,58 +1404,180 @@ unsigned short * biggishint_internal_addsubtract(unsigned short * bi1,
         else {
             smaller = bi1; larger  = bi2; sign = sign2;
         }
-        resultsize = (* larger & 0xfffc) >> 1;
-        result1 = (unsigned short *) calloc(resultsize, sizeof(short));
-        result2 = result1 + resultsize;
-        p1 = larger  + ((* larger  & 0xfffc) >> 1);
-        p2 = smaller + ((* smaller & 0xfffc) >> 1);
-        carry = 0;
-        partialresult = 0;
-        while (--p1 > larger) {
-            i1 = * p1;
-            i2 = (--p2 > smaller) ? * p2 : 0;
-            partialresult += i1 - i2;
-            * --result2 = (partialresult >=0)
-                          ? (unsigned short) partialresult
-                          : (unsigned short) (partialresult + 65536);
-            partialresult = (partialresult & 0xffff0000) ? -1 : 0;
+        resultsize = BIGGISHINT_SIZE(larger);
+        result1 = biggishint_internal_alloc(resultsize);
+        /* The smaller number may have more (leading zero) words than */
+        /* the larger one, those are simply left out. */
+        words1 = resultsize - 1;
+        words2 = (BIGGISHINT_SIZE(smaller)) - 1;
+        if (words2 > words1) words2 = words1;
+        p1 = larger  + 1 + words1 - words2;
+        p2 = smaller + (BIGGISHINT_SIZE(smaller)) - words2;
+        result2 = result1 + 1 + words1 - words2;
+        carry = biggishint_kernel_subtract(result2, p1, p2, words2, 0);
+        /* Propagate the borrow through the rest of the larger number */
+        while (p1 > larger + 1) {
+            partialresult = * --p1 - carry;
+            * --result2 = (unsigned short) partialresult;
+            carry = (partialresult >> 16) & 1;
         }
+        assert( carry == 0 );
     }  /* subtract */
     else {  /* same signs, do an add */
-        bi1size = (* bi1 & 0xfffc) >> 1;
-        bi2size = (* bi2 & 0xfffc) >> 1;
+        bi1size = BIGGISHINT_SIZE(bi1);
+        bi2size = BIGGISHINT_SIZE(bi2);
         res1size = bi1size + (bi1[1] ? 1 : 0); /* the first word may be 0 */
         res2size = bi2size + (bi2[1] ? 1 : 0);
-        resultsize  = ((res1size > res2size ? res1size : res2size) + 1) & 0xfffe;
+        resultsize  = ((res1size > res2size ? res1size : res2size) + 1) & ~1UL;
         sign = sign1;
-        result1 = (unsigned short *) calloc(resultsize, sizeof(short));
-        assert( result1 != NULL );
-        /* Initialize pointers to the augend (bi1), addend (bi2) and partialresult */
-        * result1 = resultsize << 1;
-        p1      = bi1 + bi1size - 1;
-        p2      = bi2 + bi2size - 1;
-        result2 = result1 + resultsize - 1;
-        carry = 0;
-        /* Iteratively add words from least significant to most */
-        while (result2 > result1) {
-            i1 = i2 = 0;
-            if (p1 > bi1)
-                i1 = * p1--;
-            if (p2 > bi2)
-                i2 = * p2--;
-            partialresult = i1 + i2 + carry;
-            carry = 0;
-            if (partialresult > USHRT_MAX) {
-                carry = 1;
-                partialresult -= (USHRT_MAX + 1);
-            }
-            * result2-- = (unsigned short) partialresult;
-        }  /* while */
+        result1 = biggishint_internal_alloc(resultsize);
+        /* Add the words that both numbers have, then carry through */
+        /* the remaining words of the longer number */
+        if (bi1size >= bi2size) {
+            larger  = bi1; smaller = bi2;
+        }
+        else {
+            larger  = bi2; smaller = bi1;
+        }
+        words1 = (BIGGISHINT_SIZE(larger)) - 1;
+        words2 = (BIGGISHINT_SIZE(smaller)) - 1;
+        p1 = larger  + 1 + words1 - words2;
+        p2 = smaller + 1;
+        result2 = result1 + resultsize - words2;
+        carry = biggishint_kernel_add(result2, p1, p2, words2, 0);
+        while (p1 > larger + 1) {
+            partialresult = * --p1 + carry;
+            * --result2 = (unsigned short) partialresult;
+            carry = partialresult >> 16;
+        }
+        if (carry)
+            * --result2 = carry;
     }  /* add */
-    * result1 = (resultsize << 1) | sign;
+    * result1 = BIGGISHINT_HEADER(resultsize) | sign;
     return biggishint_internal_trim(&result1);
 }
 
+
+/* biggishint_internal_addwords */
+/* result = w1 + w2 + carry over wordcount words, returns the carry. */
+/* This is the portable kernel, see biggishint_internal_selectkernels. */
+unsigned int
+biggishint_internal_addwords(unsigned short * result, unsigned short * w1,
+    unsigned short * w2, unsigned int wordcount, unsigned int carry)
+{
+    unsigned long partialresult;
+    while (wordcount--) {
+        partialresult = (unsigned long) w1[wordcount] + w2[wordcount] + carry;
+        result[wordcount] = (unsigned short) partialresult;
+        carry = (unsigned int) (partialresult >> 16);
+    }
+    return carry;
+}
+
+
+/* biggishint_internal_alloc */
+/* Allocate a zero filled biggishint of wordcount words (including */
+/* word 0, which the caller must fill in with BIGGISHINT_HEADER).  The */
+/* small sizes come from the calling thread's free list when it has */
+/* one available, the large ones get the two extra size words. */
+unsigned short *
+biggishint_internal_alloc(unsigned long wordcount)
+{
+    unsigned short * bi1;
+#ifndef BIGGISHINT_NO_POOL
+    int sizeclass;
+#endif
+    assert( wordcount <= BIGGISHINT_MAXSIZE );  /* TODO: overflow */
+    if (wordcount > BIGGISHINT_MAXSHORTSIZE) {
+        bi1 = (unsigned short *) calloc(wordcount + 2, sizeof(short));
+        ++biggishint_allocations;
+        assert( bi1 != NULL );
+        bi1[0] = (unsigned short) (wordcount >> 16);
+        bi1[1] = (unsigned short) wordcount;
+        return bi1 + 2;
+    }
+#ifndef BIGGISHINT_NO_POOL
+    sizeclass = BIGGISHINT_POOL_CLASS(wordcount);
+    if (sizeclass) {
+        bi1 = (unsigned short *) biggishint_pool_head[sizeclass];
+        if (bi1) {
+            biggishint_pool_head[sizeclass] = * (void **) bi1;
+            --biggishint_pool_count[sizeclass];
+        }
+        else {
+            bi1 = (unsigned short *) malloc(BIGGISHINT_POOL_SLOTBYTES(wordcount));
+            ++biggishint_allocations;
+        }
+        assert( bi1 != NULL );
+        memset(bi1, 0, wordcount * sizeof(short));
+        return bi1;
+    }
+#endif
+    bi1 = (unsigned short *) calloc(wordcount, sizeof(short));
+    ++biggishint_allocations;
+    assert( bi1 != NULL );
+    return bi1;
+}
+
+
+/* biggishint_internal_bitwise */
+/* Does &, | or ^ on two's complement copies of both operands, then */
+/* converts the result back to sign and magnitude.  Each copy has one */
+/* more word than the longer operand so that the top word always */
+/* holds the sign extension.  The word loops have no dependencies */
+/* between iterations, so the compiler can vectorize them. */
+unsigned short *
+biggishint_internal_bitwise(unsigned short * bi1, unsigned short * bi2, char op)
+{
+    unsigned short * result, * pa, * pb, * twos;
+    unsigned long bi1size, bi2size, words, resultsize, i;
+    unsigned int sign1, sign2, sign, carry;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    bi2size = BIGGISHINT_SIZE(bi2);
+    sign1   = * bi1 & 1;
+    sign2   = * bi2 & 1;
+    words   = (bi1size > bi2size ? bi1size : bi2size);  /* data + 1 */
+    resultsize = (words + 2) & ~1UL;
+    result  = biggishint_internal_alloc(resultsize);
+    twos    = (unsigned short *) calloc(words, sizeof(short));
+    ++biggishint_allocations;
+    assert( twos != NULL );
+    /* Right align both magnitudes, pa in result and pb in twos */
+    pa = result + resultsize - words;
+    pb = twos;
+    memcpy(pa + words - (bi1size - 1), bi1 + 1, (bi1size - 1) * sizeof(short));
+    memcpy(pb + words - (bi2size - 1), bi2 + 1, (bi2size - 1) * sizeof(short));
+    /* Negate the negative ones: invert every word, then add 1 */
+    if (sign1)
+        for (carry=1, i=words; i-- > 0; carry >>= 16)
+            pa[i] = carry = (pa[i] ^ 0xffff) + carry;
+    if (sign2)
+        for (carry=1, i=words; i-- > 0; carry >>= 16)
+            pb[i] = carry = (pb[i] ^ 0xffff) + carry;
+    switch (op) {
+        case '&':
+            for (i=0; i<words; ++i) pa[i] &= pb[i];
+            sign = sign1 & sign2;
+            break;
+        case '|':
+            for (i=0; i<words; ++i) pa[i] |= pb[i];
+            sign = sign1 | sign2;
+            break;
+        default:
+            for (i=0; i<words; ++i) pa[i] ^= pb[i];
+            sign = sign1 ^ sign2;
+            break;
+    }
+    free(twos);
+    /* A negative result goes back to sign and magnitude the same way */
+    if (sign)
+        for (carry=1, i=words; i-- > 0; carry >>= 16)
+            pa[i] = carry = (pa[i] ^ 0xffff) + carry;
+    * result = BIGGISHINT_HEADER(resultsize) | sign;
+    return biggishint_internal_trim(&result);
+}
+
+
 /* biggishint_internal_bitsize */
 /* Count how many bits a number uses (0-64), returns 1 + position of first 1 bit */
 int
@@ -720,11 +1594,11 @@ biggishint_internal_bitsize(unsigned long n)
 unsigned short *
 biggishint_internal_clone(unsigned short * bi1)
 {
-    unsigned short clonebytes, * clone;
-    clonebytes = * bi1 & 0xfffffffe;
-    clone = (unsigned short *) malloc(clonebytes);
-    assert( clone != NULL );
-    memcpy(clone, bi1, clonebytes);
+    unsigned short * clone;
+    unsigned long clonewords;
+    clonewords = BIGGISHINT_SIZE(bi1);
+    clone = biggishint_internal_alloc(clonewords);
+    memcpy(clone, bi1, clonewords * sizeof(short));  /* word 0 too */
     return clone;
 }
 
@@ -733,95 +1607,543 @@ biggishint_internal_clone(unsigned short * bi1)
 /* returns -1 if bi1<bi2, 0 if bi1==bi2, +1 if bi1>bi2 */
 int biggishint_internal_comparemagnitude(unsigned short * bi1, unsigned short * bi2)
 {
-    unsigned short * pi1data, * pi1, * pi2data, * pi2;
-    unsigned short i1, i2, bi1size, bi2size, loopcount;
-    int result=0;
+    unsigned short * pi1, * pi2;
+    unsigned long bi1size, bi2size;
     /* This function could often be quicker by comparing the sizes of */
     /* the two numbers, but that implies trusting the rest of the */
     /* code to always trim leading zero words where possible.  The */
     /* test suite currently lacks the coverage required to enable */
-    /* that trust. */
-    bi1size = (* bi1 & 0xfffc) >> 1;
-    bi2size = (* bi2 & 0xfffc) >> 1;
-    /* the max number of comparisons is max(bi1size,bi2size)-1 */
-    loopcount = ((bi1size>bi2size) ? bi1size : bi2size) - 1;
-    pi1data = bi1 + 1;
-    pi2data = bi2 + 1;
-    pi1     = bi1 + bi1size - loopcount;
-    pi2     = bi2 + bi2size - loopcount;
-    while (result==0 && loopcount--) {
-        /* substitute leading zeroes for whichever number is shorter */
-        i1 = (pi1<pi1data) ? 0 : * pi1;  ++pi1;
-        i2 = (pi2<pi2data) ? 0 : * pi2;  ++pi2;
-        /* compare the two words from each biggishint */
-        result = (i1<i2) ? -1 : (i1>i2) ? 1 : 0;
+    /* that trust.  Instead, the extra leading words of the longer */
+    /* number are checked for zeroes. */
+    if (biggishint_kernel_compare == NULL)
+        biggishint_internal_selectkernels(0);
+    bi1size = BIGGISHINT_SIZE(bi1);
+    bi2size = BIGGISHINT_SIZE(bi2);
+    pi1 = bi1 + 1;
+    pi2 = bi2 + 1;
+    for ( ; bi1size > bi2size; --bi1size)
+        if (* pi1++)
+            return 1;
+    for ( ; bi2size > bi1size; --bi2size)
+        if (* pi2++)
+            return -1;
+    return biggishint_kernel_compare(pi1, pi2, bi1size - 1);
+}
+
+
+/* biggishint_internal_comparewords */
+/* Compares wordcount words, most significant first.  Portable kernel. */
+int
+biggishint_internal_comparewords(unsigned short * w1, unsigned short * w2, unsigned int wordcount)
+{
+    unsigned int i;
+    for (i=0; i<wordcount; ++i)
+        if (w1[i] != w2[i])
+            return (w1[i] < w2[i]) ? -1 : 1;
+    return 0;
+}
+
+
+/* biggishint_internal_free */
+/* Release a biggishint.  Word 0 must still hold the allocated size. */
+void
+biggishint_internal_free(unsigned short * bi1)
+{
+#ifndef BIGGISHINT_NO_POOL
+    int sizeclass;
+#endif
+    if (bi1 == NULL)
+        return;
+    if ((* bi1 & 0xfffc) == 0) {  /* the block starts at word -2 */
+        free(bi1 - 2);
+        return;
+    }
+#ifndef BIGGISHINT_NO_POOL
+    sizeclass = BIGGISHINT_POOL_CLASS(BIGGISHINT_SIZE(bi1));
+    if (sizeclass && biggishint_pool_count[sizeclass] < BIGGISHINT_POOL_MAXFREE) {
+        * (void **) bi1 = biggishint_pool_head[sizeclass];
+        biggishint_pool_head[sizeclass] = bi1;
+        ++biggishint_pool_count[sizeclass];
+        return;
+    }
+#endif
+    free(bi1);
+}
+
+
+/* biggishint_internal_fromdigits */
+/* Makes a (trimmed, positive) biggishint from little endian digits. */
+unsigned short *
+biggishint_internal_fromdigits(biggishint_internal_digit * digits, int digitcount)
+{
+    unsigned short * result, * p1;
+    unsigned long resultsize;
+    int i, j;
+    resultsize = ((unsigned long) digitcount * BIGGISHINT_DIGIT_WORDS + 2) & ~1UL;
+    result = biggishint_internal_alloc(resultsize);
+    * result = BIGGISHINT_HEADER(resultsize);
+    p1 = result + resultsize;
+    for (i=0; i<digitcount; ++i)
+        for (j=0; j<BIGGISHINT_DIGIT_WORDS; ++j)
+            * --p1 = (unsigned short) (digits[i] >> (j << 4));
+    return biggishint_internal_trim(&result);
+}
+
+
+/* biggishint_internal_magnitude */
+/* Returns the absolute value as an unsigned long, or ULONG_MAX if it */
+/* does not fit.  Used for shift counts. */
+unsigned long
+biggishint_internal_magnitude(unsigned short * bi1)
+{
+    unsigned short * p1;
+    unsigned long bi1size, magnitude = 0;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    for (p1=bi1+1; p1<bi1+bi1size; ++p1) {
+        if (magnitude > (ULONG_MAX >> 16))
+            return ULONG_MAX;
+        magnitude = (magnitude << 16) | * p1;
+    }
+    return magnitude;
+}
+
+
+/* biggishint_internal_montgomerymultiply */
+/* result = a * b / R mod modulus, where R = 2**(digitcount*digitbits). */
+/* All numbers are little endian arrays of digitcount digits, and a */
+/* and b must be less than modulus, which must be odd.  minverse is */
+/* -1/modulus[0] mod 2**digitbits.  scratch needs digitcount+2 digits. */
+/* result may be the same array as a or b.  This is the CIOS (coarsely */
+/* integrated operand scanning) method: every outer loop adds one */
+/* digit of a times b, then adds a multiple of modulus that makes the */
+/* lowest digit 0, and shifts down by one digit. */
+void
+biggishint_internal_montgomerymultiply(biggishint_internal_digit * result,
+    biggishint_internal_digit * a, biggishint_internal_digit * b,
+    biggishint_internal_digit * modulus, biggishint_internal_digit minverse,
+    int digitcount, biggishint_internal_digit * scratch)
+{
+    biggishint_internal_doubledigit carry, sum;
+    biggishint_internal_digit multiplier, * t = scratch;
+    int i, j, n = digitcount;
+    memset(t, 0, (n + 2) * sizeof(biggishint_internal_digit));
+    for (i=0; i<n; ++i) {
+        carry = 0;
+        for (j=0; j<n; ++j) {
+            sum   = t[j] + (biggishint_internal_doubledigit) a[i] * b[j] + carry;
+            t[j]  = (biggishint_internal_digit) sum;
+            carry = sum >> BIGGISHINT_DIGIT_BITS;
+        }
+        sum    = t[n] + carry;
+        t[n]   = (biggishint_internal_digit) sum;
+        t[n+1] = (biggishint_internal_digit) (sum >> BIGGISHINT_DIGIT_BITS);
+        multiplier = (biggishint_internal_digit) ((biggishint_internal_doubledigit) t[0] * minverse);
+        sum   = t[0] + (biggishint_internal_doubledigit) multiplier * modulus[0];
+        carry = sum >> BIGGISHINT_DIGIT_BITS;
+        for (j=1; j<n; ++j) {
+            sum    = t[j] + (biggishint_internal_doubledigit) multiplier * modulus[j] + carry;
+            t[j-1] = (biggishint_internal_digit) sum;
+            carry  = sum >> BIGGISHINT_DIGIT_BITS;
+        }
+        sum    = t[n] + carry;
+        t[n-1] = (biggishint_internal_digit) sum;
+        t[n]   = t[n+1] + (biggishint_internal_digit) (sum >> BIGGISHINT_DIGIT_BITS);
+    }
+    /* t < 2*modulus now, so at most one subtraction is needed */
+    i = n;
+    if (t[n] == 0)
+        for (i=n-1; i>0 && t[i] == modulus[i]; --i)
+            ;
+    if (t[n] || t[i] >= modulus[i]) {
+        carry = 0;  /* used as the borrow */
+        for (j=0; j<n; ++j) {
+            sum       = (biggishint_internal_doubledigit) t[j] - modulus[j] - carry;
+            result[j] = (biggishint_internal_digit) sum;
+            carry     = (sum >> BIGGISHINT_DIGIT_BITS) & 1;
+        }
+    }
+    else
+        memcpy(result, t, n * sizeof(biggishint_internal_digit));
+}
+
+
+/* biggishint_internal_multiplythreads */
+/* result = w1 * w2 like biggishint_internal_multiplywords, but with */
+/* the rows of w1 split into blocks that are multiplied on the worker */
+/* threads, the calling thread doing one block itself.  Each block */
+/* gets its own buffer, and the buffers are added into result at the */
+/* end.  Returns 0, having done nothing, if the numbers are too small, */
+/* there is only one thread, or another thread has the workers. */
+int
+biggishint_internal_multiplythreads(unsigned short * result, unsigned short * w1,
+    unsigned long words1, unsigned short * w2, unsigned long words2)
+{
+#ifdef BIGGISHINT_THREADS
+    struct biggishint_internal_task tasks[BIGGISHINT_MAXTHREADS], * task;
+    unsigned short * buffers, * buffer, * p1;
+    unsigned long start, end;
+    unsigned int carry;
+    int taskcount, t;
+    if (words1 < BIGGISHINT_THREAD_THRESHOLD || words2 < BIGGISHINT_THREAD_THRESHOLD)
+        return 0;
+    taskcount = biggishintThreads(0);
+    if (words1 / (BIGGISHINT_THREAD_THRESHOLD / 2) < (unsigned long) taskcount)
+        taskcount = (int) (words1 / (BIGGISHINT_THREAD_THRESHOLD / 2));
+    if (taskcount < 2 || pthread_mutex_trylock(&biggishint_workers_busy))
+        return 0;
+    while (biggishint_workers_count < taskcount - 1) {
+        if (pthread_create(biggishint_workers + biggishint_workers_count, NULL,
+                biggishint_internal_worker, NULL))
+            break;
+        ++biggishint_workers_count;
+    }
+    if (taskcount > biggishint_workers_count + 1)
+        taskcount = biggishint_workers_count + 1;
+    if (biggishint_kernel_add == NULL)
+        biggishint_internal_selectkernels(0);
+    buffers = (unsigned short *) calloc(words1 + taskcount * words2, sizeof(short));
+    ++biggishint_allocations;
+    assert( buffers != NULL );
+    /* Block t is rows start to end-1 of w1, and its product belongs */
+    /* at result + start */
+    buffer = buffers;
+    for (t=0; t<taskcount; ++t) {
+        start = words1 * t / taskcount;
+        end   = words1 * (t + 1) / taskcount;
+        tasks[t].result = buffer;
+        tasks[t].w1     = w1 + start;
+        tasks[t].words1 = end - start;
+        tasks[t].w2     = w2;
+        tasks[t].words2 = words2;
+        buffer += end - start + words2;
+    }
+    pthread_mutex_lock(&biggishint_workers_mutex);
+    biggishint_workers_tasks      = tasks;
+    biggishint_workers_next       = 0;
+    biggishint_workers_taskcount  = taskcount;
+    biggishint_workers_unfinished = taskcount;
+    pthread_cond_broadcast(&biggishint_workers_wake);
+    while (biggishint_workers_next < biggishint_workers_taskcount) {
+        task = tasks + biggishint_workers_next++;
+        pthread_mutex_unlock(&biggishint_workers_mutex);
+        biggishint_internal_multiplywords(task->result, task->w1, task->words1,
+            task->w2, task->words2);
+        pthread_mutex_lock(&biggishint_workers_mutex);
+        --biggishint_workers_unfinished;
+    }
+    while (biggishint_workers_unfinished)
+        pthread_cond_wait(&biggishint_workers_done, &biggishint_workers_mutex);
+    pthread_mutex_unlock(&biggishint_workers_mutex);
+    /* Add up the blocks, carrying into the higher words */
+    for (t=0; t<taskcount; ++t) {
+        p1 = result + (tasks[t].w1 - w1);
+        carry = biggishint_kernel_add(p1, p1, tasks[t].result,
+            tasks[t].words1 + words2, 0);
+        while (carry && p1 > result)
+            carry = ++(* --p1) == 0;
+    }
+    assert( carry == 0 );
+    free(buffers);
+    pthread_mutex_unlock(&biggishint_workers_busy);
+    return 1;
+#else
+    (void) result; (void) w1; (void) words1; (void) w2; (void) words2;
+    return 0;
+#endif
+}
+
+
+/* biggishint_internal_multiplywords */
+/* result = w1 * w2, schoolbook style.  All are arrays of words in */
+/* biggishint (big endian) order, and result has words1 + words2 */
+/* words, which must be 0 to start with. */
+void
+biggishint_internal_multiplywords(unsigned short * result, unsigned short * w1,
+    unsigned long words1, unsigned short * w2, unsigned long words2)
+{
+    unsigned short * p2, * presult;
+    unsigned long i1, n1, subtotal, carry;
+    for (i1=0; i1<words1; ++i1) {
+        n1 = w1[words1 - 1 - i1];
+        if (n1 == 0)
+            continue;
+        presult = result + words1 + words2 - 1 - i1;
+        carry = 0;
+        for (p2=w2+words2; p2>w2; ) {
+            subtotal = * presult + n1 * * --p2 + carry;
+            carry = subtotal >> 16;
+            * presult-- = (unsigned short) subtotal;
+        }
+        /* No earlier row has reached this word yet */
+        * presult = (unsigned short) carry;
     }
-    return result;
 }
 
+
+/* biggishint_internal_resize */
+/* The equivalent of realloc() for biggishints, keeping the first */
+/* words.  Word 0 must still hold the old size, the caller sets the */
+/* new one.  Pooled blocks are never passed to realloc, because a */
+/* realloc could shrink them below the size of a free list slot, and */
+/* neither are blocks that gain or lose the two extra size words. */
+unsigned short *
+biggishint_internal_resize(unsigned short * bi1, unsigned long wordcount)
+{
+    unsigned short * resized;
+    unsigned long oldwordcount;
+    int move;
+    oldwordcount = BIGGISHINT_SIZE(bi1);
+    move = (oldwordcount > BIGGISHINT_MAXSHORTSIZE) != (wordcount > BIGGISHINT_MAXSHORTSIZE);
+#ifndef BIGGISHINT_NO_POOL
+    move |= BIGGISHINT_POOL_CLASS(oldwordcount) || BIGGISHINT_POOL_CLASS(wordcount);
+#endif
+    if (move) {
+        resized = biggishint_internal_alloc(wordcount);
+        memcpy(resized, bi1,
+            (oldwordcount < wordcount ? oldwordcount : wordcount) * sizeof(short));
+        biggishint_internal_free(bi1);
+        return resized;
+    }
+    if (wordcount > BIGGISHINT_MAXSHORTSIZE) {
+        resized = (unsigned short *) realloc(bi1 - 2, (wordcount + 2) * sizeof(short));
+        assert( resized != NULL );
+        resized[0] = (unsigned short) (wordcount >> 16);
+        resized[1] = (unsigned short) wordcount;
+        resized += 2;
+    }
+    else
+        resized = (unsigned short *) realloc(bi1, wordcount * sizeof(short));
+    ++biggishint_allocations;
+    assert( resized != NULL );
+    if (wordcount > oldwordcount)
+        memset(resized + oldwordcount, 0, (wordcount - oldwordcount) * sizeof(short));
+    return resized;
+}
+
+
+/* biggishint_internal_selectkernels */
+/* Chooses the add, subtract and compare kernels, from CPUID on x86-64 */
+/* unless portable is set.  Two threads racing through here both */
+/* store the same values, so no locking is needed. */
+#ifdef BIGGISHINT_X86_64
+/* Reverses the order of the four 16-bit words in a 64-bit value, to */
+/* convert between biggishint word order and little endian order. */
+static unsigned long long
+biggishint_internal_reversewords(unsigned long long v)
+{
+    v = (v >> 32) | (v << 32);
+    return ((v >> 16) & 0x0000ffff0000ffffULL) | ((v & 0x0000ffff0000ffffULL) << 16);
+}
+
+/* Add 64 bits (4 words) at a time with the ADX add with carry */
+__attribute__((target("adx")))
+static unsigned int
+biggishint_internal_addwords_adx(unsigned short * result, unsigned short * w1,
+    unsigned short * w2, unsigned int wordcount, unsigned int carry)
+{
+    unsigned long long v1, v2, v3;
+    unsigned char c = (unsigned char) carry;
+    while (wordcount >= 4) {
+        wordcount -= 4;
+        memcpy(&v1, w1 + wordcount, 8);
+        memcpy(&v2, w2 + wordcount, 8);
+        c = _addcarryx_u64(c, biggishint_internal_reversewords(v1),
+                biggishint_internal_reversewords(v2), &v3);
+        v3 = biggishint_internal_reversewords(v3);
+        memcpy(result + wordcount, &v3, 8);
+    }
+    return biggishint_internal_addwords(result, w1, w2, wordcount, c);
+}
+
+/* Subtract 64 bits at a time with the subtract with borrow instruction */
+__attribute__((target("adx")))
+static unsigned int
+biggishint_internal_subtractwords_adx(unsigned short * result, unsigned short * w1,
+    unsigned short * w2, unsigned int wordcount, unsigned int borrow)
+{
+    unsigned long long v1, v2, v3;
+    unsigned char b = (unsigned char) borrow;
+    while (wordcount >= 4) {
+        wordcount -= 4;
+        memcpy(&v1, w1 + wordcount, 8);
+        memcpy(&v2, w2 + wordcount, 8);
+        b = _subborrow_u64(b, biggishint_internal_reversewords(v1),
+                biggishint_internal_reversewords(v2), &v3);
+        v3 = biggishint_internal_reversewords(v3);
+        memcpy(result + wordcount, &v3, 8);
+    }
+    return biggishint_internal_subtractwords(result, w1, w2, wordcount, b);
+}
+
+/* Skip equal words 16 at a time with AVX2, the first difference is */
+/* found from the comparison mask */
+__attribute__((target("avx2")))
+static int
+biggishint_internal_comparewords_avx2(unsigned short * w1, unsigned short * w2, unsigned int wordcount)
+{
+    unsigned int i = 0, mask;
+    __m256i v1, v2;
+    for ( ; i + 16 <= wordcount; i += 16) {
+        v1   = _mm256_loadu_si256((__m256i *) (w1 + i));
+        v2   = _mm256_loadu_si256((__m256i *) (w2 + i));
+        mask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi16(v1, v2));
+        if (mask != 0xffffffffU) {
+            i += __builtin_ctz(~mask) >> 1;  /* two mask bits per word */
+            return (w1[i] < w2[i]) ? -1 : 1;
+        }
+    }
+    return biggishint_internal_comparewords(w1 + i, w2 + i, wordcount - i);
+}
+#endif
+
+void
+biggishint_internal_selectkernels(int portable)
+{
+    biggishint_kernel_add      = biggishint_internal_addwords;
+    biggishint_kernel_subtract = biggishint_internal_subtractwords;
+    biggishint_kernel_compare  = biggishint_internal_comparewords;
+    biggishint_kernel_names    = "portable";
+#ifdef BIGGISHINT_X86_64
+    if (! portable) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("adx")) {
+            biggishint_kernel_add      = biggishint_internal_addwords_adx;
+            biggishint_kernel_subtract = biggishint_internal_subtractwords_adx;
+            biggishint_kernel_names    = "adx";
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            biggishint_kernel_compare  = biggishint_internal_comparewords_avx2;
+            biggishint_kernel_names    = (biggishint_kernel_add == biggishint_internal_addwords)
+                                       ? "avx2" : "adx+avx2";
+        }
+    }
+#endif
+}
+
+
 /* biggishint_internal_shiftleft */
+/* Moves whole words first and then shifts the remaining 0-15 bits in */
+/* a single pass.  Each result word only depends on two input words, */
+/* so the compiler can vectorize the loop. */
 unsigned short *
-biggishint_internal_shiftleft(unsigned short * bi1, unsigned int bitcount)
-{
-    unsigned short bi1size, * result, * p1, * p2, carry;
-    unsigned int inputbitcount, resultbitcount, resultsize, inputloop;
-    unsigned int shiftleft, shiftright, inputword, resultword;
-    bi1size = (* bi1 & 0xfffc) >> 1;
-    /* Calculate the number of data bits needed for the result */
-    inputbitcount = biggishint_internal_bitsize(bi1[1]) + ((bi1size - 2) << 4);
-    resultbitcount = inputbitcount + bitcount;
-    assert( resultbitcount < 524272);
-    /* Calculate the total number of words to allocate for the result */
-    resultsize = 1 + ((resultbitcount + 15) >> 4);
-    result = (unsigned short *) calloc(resultsize, sizeof(short));
-    * result = resultsize << 1;
-    /* prepare initial values for the loop below */
+biggishint_internal_shiftleft(unsigned short * bi1, unsigned long bitcount)
+{
+    unsigned short * result, * pin, * pout;
+    unsigned long bi1size, inputwords, resultsize, datawords, wordshift, i;
+    unsigned int shiftleft, shiftright;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    /* Skip leading zero words of the input */
+    pin = bi1 + 1;
+    inputwords = bi1size - 1;
+    while (inputwords && * pin == 0) {
+        ++pin;
+        --inputwords;
+    }
+    if (inputwords == 0) {  /* zero stays zero however far it moves */
+        result = biggishint_internal_alloc(2);
+        * result = 4;
+        return result;
+    }
+    wordshift  = bitcount >> 4;
     shiftleft  = bitcount & 0xf;
     shiftright = 16 - shiftleft;
-    p1 = bi1 + 1;
-    p2 = result + 1;
-    inputword = * p1++;
-    inputloop = bi1size;
-    carry = inputword << shiftleft;
-    /* Check whether part of the first word of the input needs to */
-    /* carry over to the second word of the result */
-    if ( ((inputbitcount-1) & 0xf) > ((resultbitcount-1) & 0xf) ) {
-        /* Yes, so here store the bits that will not be carried */
-        resultword = inputword >> shiftright;
-        * p2++ = resultword;
-        --inputloop;
-    }
-    while (--inputloop) {
-        inputword = * p1++;
-        resultword = carry | (inputword >> shiftright);
-        * p2++ = resultword;
-        carry = inputword << shiftleft;
-    }
-    * p2++ = carry;
+    /* Calculate the number of data words needed for the result, one */
+    /* more if the top bits of pin[0] spill into another word */
+    assert( wordshift < BIGGISHINT_MAXSIZE - inputwords - 2 );  /* TODO: overflow */
+    datawords  = inputwords + wordshift
+               + (biggishint_internal_bitsize(* pin) + shiftleft > 16);
+    resultsize = (datawords + 2) & ~1UL;
+    result = biggishint_internal_alloc(resultsize);
+    * result = BIGGISHINT_HEADER(resultsize) | (* bi1 & 1);
+    /* pout receives the bits of pin[0] that stay in the same word, the */
+    /* wordshift words after the input stay zero */
+    pout = result + resultsize - wordshift - inputwords;
+    for (i=0; i+1<inputwords; ++i)
+        pout[i] = (unsigned short) ((pin[i] << shiftleft) | (pin[i+1] >> shiftright));
+    pout[inputwords-1] = (unsigned short) (pin[inputwords-1] << shiftleft);
+    /* The top bits of pin[0] may spill into one more word */
+    if (datawords > inputwords + wordshift)
+        pout[-1] = pin[0] >> shiftright;
     return result;
 }
 
 
-/* TODO: biggishint_internal_shiftright */
+/* biggishint_internal_shiftright */
+/* Like shiftleft, whole words are dropped and the rest are shifted in */
+/* one pass.  Negative numbers round towards minus infinity: if any 1 */
+/* bits were shifted out, the magnitude is incremented. */
 unsigned short *
-biggishint_internal_shiftright(unsigned short * bi1, unsigned int bitcount)
+biggishint_internal_shiftright(unsigned short * bi1, unsigned long bitcount)
 {
-    unsigned short bi1size, * result;
-    bi1size = 2;
-    result = (unsigned short *) malloc(bi1size);
+    unsigned short * result, * pin, * pout;
+    unsigned long bi1size, inputwords, keepwords, resultsize, i, wordshift, carry;
+    unsigned int shiftleft, shiftright, sign, lost;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    sign = * bi1 & 1;
+    pin = bi1 + 1;
+    inputwords = bi1size - 1;
+    wordshift  = bitcount >> 4;
+    shiftright = bitcount & 0xf;
+    shiftleft  = 16 - shiftright;
+    keepwords  = (wordshift < inputwords) ? inputwords - wordshift : 0;
+    /* Find out whether any 1 bits fall off the end */
+    lost = 0;
+    for (i=keepwords; i<inputwords; ++i)
+        lost |= pin[i];
+    if (keepwords)
+        lost |= pin[keepwords-1] & ((1U << shiftright) - 1);
+    /* Allocate one spare word for the carry of the increment */
+    resultsize = (keepwords + 3) & ~1UL;
+    result = biggishint_internal_alloc(resultsize);
+    * result = BIGGISHINT_HEADER(resultsize) | sign;
+    pout = result + resultsize - keepwords;
+    if (keepwords) {
+        pout[0] = pin[0] >> shiftright;
+        for (i=1; i<keepwords; ++i)
+            pout[i] = (unsigned short) (((unsigned int) pin[i-1] << shiftleft) | (pin[i] >> shiftright));
+    }
+    if (sign && lost)
+        for (carry=1, pout=result+resultsize; carry && --pout>result; carry >>= 16)
+            * pout = carry = * pout + carry;
     return result;
 }
 
 
+/* biggishint_internal_shiftrightwords */
+/* Shifts a run of wordcount words (big endian, no word 0) right by */
+/* bitcount bits in place, filling in zeroes at the top. */
+void
+biggishint_internal_shiftrightwords(unsigned short * words, unsigned long wordcount, unsigned long bitcount)
+{
+    unsigned long wordshift, i;
+    unsigned int shiftright, shiftleft;
+    wordshift  = bitcount >> 4;
+    shiftright = bitcount & 0xf;
+    shiftleft  = 16 - shiftright;
+    if (wordshift >= wordcount) {
+        memset(words, 0, wordcount * sizeof(short));
+        return;
+    }
+    /* Each word only reads words at or above its own position */
+    for (i=wordcount-1; i>wordshift; --i)
+        words[i] = shiftright
+            ? (unsigned short) (((unsigned int) words[i-wordshift-1] << shiftleft) | (words[i-wordshift] >> shiftright))
+            : words[i-wordshift];
+    words[wordshift] = words[0] >> shiftright;
+    memset(words, 0, wordshift * sizeof(short));
+}
+
+
 /* biggishint_internal_shortdivide */
 /* Short division only (divisor <= 0xffff). */
 /* Returns quotient in (* bi1), remainder in (* i2) */
 void
 biggishint_internal_shortdivide(unsigned short * bi1, unsigned short * i2)
 {
-    unsigned short bi1size, * pi1, * pi2, divisor, remainder, hi, lo;
+    unsigned short * pi1, * pi2, divisor, remainder, hi, lo;
+    unsigned long bi1size;
     unsigned long partialdividend, partialquotient;
-    bi1size   = (* bi1 & 0xfffc) >> 1;
+    bi1size   = BIGGISHINT_SIZE(bi1);
     divisor   = * i2;
     remainder = 0;
     pi1       = bi1 + 1;
@@ -845,19 +2167,20 @@ biggishint_internal_shortdivide(unsigned short * bi1, unsigned short * i2)
 void
 biggishint_internal_shortmultiply(unsigned short ** bi1, unsigned short multiplier)
 {
-    unsigned short bi1size, productsize, * product, * pi, * pp;
+    unsigned short * product, * pi, * pp;
+    unsigned long bi1size, productsize;
     unsigned long productcarry;
     if (multiplier == 0) {
-        * bi1 = realloc(* bi1, sizeof(short)<<1);
+        * bi1 = biggishint_internal_resize(* bi1, 2);
         (* bi1)[0] = 4;  (* bi1)[1] = 0;
     }
     else {
         if (multiplier != 1) {
             /* TODO: avoid realloc if possible */
-            bi1size   = (** bi1 & 0xfffc) >> 1;
+            bi1size   = BIGGISHINT_SIZE(* bi1);
             productsize = bi1size + 2;  /* even number of words */
-            product = (unsigned short *) calloc(productsize, sizeof(short));
-            * product = productsize << 1;
+            product = biggishint_internal_alloc(productsize);
+            * product = BIGGISHINT_HEADER(productsize);
             pi = * bi1   + bi1size     - 1;
             pp = product + productsize - 1;
             productcarry = 0;
@@ -871,7 +2194,7 @@ biggishint_internal_shortmultiply(unsigned short ** bi1, unsigned short multipli
                 (* pp--) = (unsigned short) productcarry;
                 productcarry >>= 16;
             }
-            free(* bi1);
+            biggishint_internal_free(* bi1);
             * bi1 = product;
             biggishint_internal_trim(bi1);
         }
@@ -879,12 +2202,119 @@ biggishint_internal_shortmultiply(unsigned short ** bi1, unsigned short multipli
 }
 
 
+#ifdef BIGGISHINT_THREADS
+/* biggishint_internal_stopworkers */
+/* Ends the worker threads, the caller must hold the busy mutex */
+static void
+biggishint_internal_stopworkers(void)
+{
+    int i;
+    pthread_mutex_lock(&biggishint_workers_mutex);
+    biggishint_workers_exit = 1;
+    pthread_cond_broadcast(&biggishint_workers_wake);
+    pthread_mutex_unlock(&biggishint_workers_mutex);
+    for (i=0; i<biggishint_workers_count; ++i)
+        pthread_join(biggishint_workers[i], NULL);
+    biggishint_workers_count = 0;
+    biggishint_workers_exit  = 0;
+}
+#endif
+
+
+/* biggishint_internal_subtractwords */
+/* result = w1 - w2 - borrow over wordcount words, returns the borrow. */
+/* This is the portable kernel, see biggishint_internal_selectkernels. */
+unsigned int
+biggishint_internal_subtractwords(unsigned short * result, unsigned short * w1,
+    unsigned short * w2, unsigned int wordcount, unsigned int borrow)
+{
+    unsigned long partialresult;
+    while (wordcount--) {
+        partialresult = (unsigned long) w1[wordcount] - w2[wordcount] - borrow;
+        result[wordcount] = (unsigned short) partialresult;
+        borrow = (unsigned int) (partialresult >> 16) & 1;
+    }
+    return borrow;
+}
+
+
+/* biggishint_internal_todigits */
+/* Copies the magnitude of bi1 into digitcount little endian digits, */
+/* zero filled at the top.  bi1 must fit. */
+void
+biggishint_internal_todigits(unsigned short * bi1, biggishint_internal_digit * digits, int digitcount)
+{
+    unsigned short * p1;
+    unsigned long bi1size, i;
+    bi1size = BIGGISHINT_SIZE(bi1);
+    memset(digits, 0, digitcount * sizeof(biggishint_internal_digit));
+    for (i=0, p1=bi1+bi1size-1; p1>bi1; ++i, --p1) {
+        assert( * p1 == 0 || i < (unsigned long) digitcount * BIGGISHINT_DIGIT_WORDS );
+        if (* p1)
+            digits[i / BIGGISHINT_DIGIT_WORDS] |=
+                (biggishint_internal_digit) * p1 << ((i % BIGGISHINT_DIGIT_WORDS) << 4);
+    }
+}
+
+
 /*
 #include <stdio.h>
     fprintf(stderr,"sign %d\n", sign);
 */
 
 
+/* biggishint_internal_tostringbatch */
+/* Joins the strings that convert makes of each biggishint with '\n'. */
+char *
+biggishint_internal_tostringbatch(unsigned short ** bis, int count,
+    char * (* convert)(unsigned short *))
+{
+    char ** strings, * result, * p1;
+    size_t length = 1, partlength;
+    int i;
+    strings = (char **) malloc((count ? count : 1) * sizeof(char *));
+    ++biggishint_allocations;
+    assert( strings != NULL );
+    for (i=0; i<count; ++i) {
+        strings[i] = convert(bis[i]);
+        length += strlen(strings[i]) + 1;
+    }
+    result = p1 = (char *) malloc(length);
+    ++biggishint_allocations;
+    assert( result != NULL );
+    for (i=0; i<count; ++i) {
+        if (i)
+            * p1++ = '\n';
+        partlength = strlen(strings[i]);
+        memcpy(p1, strings[i], partlength);
+        p1 += partlength;
+        free(strings[i]);
+    }
+    * p1 = '\0';
+    free(strings);
+    return result;
+}
+
+
+/* biggishint_internal_trailingzeros */
+/* The number of 0 bits below the lowest 1 bit in a run of wordcount */
+/* words, or wordcount * 16 if they are all 0. */
+unsigned long
+biggishint_internal_trailingzeros(unsigned short * words, unsigned long wordcount)
+{
+    unsigned long zeros = 0;
+    unsigned short word;
+    while (wordcount && words[wordcount-1] == 0) {
+        --wordcount;
+        zeros += 16;
+    }
+    if (wordcount)
+        for (word=words[wordcount-1]; (word & 1) == 0; word >>= 1)
+            ++zeros;
+    return zeros;
+}
+
+
 /* biggishint_internal_trim */
 /* If possible, remove leading zeroes from the front of the biggishint */
 /* Also remove the minus sign from -0 results */
@@ -901,12 +2331,12 @@ biggishint_internal_trim(unsigned short ** pbi1)
     /* | 0008 | 0000 | 1234 | cdef | */
     /* +------+------+------+------+ */
     unsigned int sign;
-    unsigned short bi1size, newsize;
+    unsigned long bi1size, newsize;
     unsigned short * bi1, * pLeft, * pSearch, * pRight, * pAfterZeroes;
 
     bi1 = * pbi1;
     /* Count the number of contiguous leading zero words */
-    bi1size      = (* bi1 & 0xfffc) >> 1;
+    bi1size      = BIGGISHINT_SIZE(bi1);
     sign         = * bi1 & 1;
     pLeft        = bi1 + 1;
     pSearch      = bi1;
@@ -921,7 +2351,7 @@ biggishint_internal_trim(unsigned short ** pbi1)
     /* If there are leading words filled with zeroes, move the non */
     /* zero words to the left to overwrite them */
     if (pAfterZeroes > pLeft) {
-        newsize = (pRight - pAfterZeroes + 2) & 0xfffe; /* always even */
+        newsize = (pRight - pAfterZeroes + 2) & ~1UL; /* always even */
         if (newsize < bi1size) {
             /* Trim the size of the memory allocation */
             /* Bump the destination by 1 if the first non zero word */
@@ -929,8 +2359,8 @@ biggishint_internal_trim(unsigned short ** pbi1)
             pLeft += (pAfterZeroes - bi1 + 1) & 1;
             /* If the array was little endian, memmove would not happen */
             memmove(pLeft, pAfterZeroes, (pRight - pAfterZeroes) << 1);
-            bi1 = realloc(bi1, newsize << 1);
-            * bi1 = (newsize << 1) | sign;
+            bi1 = biggishint_internal_resize(bi1, newsize);
+            * bi1 = BIGGISHINT_HEADER(newsize) | sign;
             * pbi1 = bi1;
         }
     }
@@ -940,4 +2370,33 @@ biggishint_internal_trim(unsigned short ** pbi1)
 }
 
 
+#ifdef BIGGISHINT_THREADS
+/* biggishint_internal_worker */
+/* The body of each worker thread: takes tasks until told to exit */
+static void *
+biggishint_internal_worker(void * unused)
+{
+    struct biggishint_internal_task * task;
+    (void) unused;
+    pthread_mutex_lock(&biggishint_workers_mutex);
+    for (;;) {
+        while (! biggishint_workers_exit
+                && biggishint_workers_next >= biggishint_workers_taskcount)
+            pthread_cond_wait(&biggishint_workers_wake, &biggishint_workers_mutex);
+        if (biggishint_workers_exit)
+            break;
+        task = biggishint_workers_tasks + biggishint_workers_next++;
+        pthread_mutex_unlock(&biggishint_workers_mutex);
+        biggishint_internal_multiplywords(task->result, task->w1, task->words1,
+            task->w2, task->words2);
+        pthread_mutex_lock(&biggishint_workers_mutex);
+        if (--biggishint_workers_unfinished == 0)
+            pthread_cond_signal(&biggishint_workers_done);
+    }
+    pthread_mutex_unlock(&biggishint_workers_mutex);
+    return NULL;
+}
+#endif
+
+
 /* end of biggishint.c */
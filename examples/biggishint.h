@@ -2,10 +2,11 @@
 
 /* Commented out entries are NYI */
 unsigned short * biggishintAdd                   (unsigned short * biggishint1, unsigned short * biggishint2);
-//unsigned short * biggishintBitwiseAnd            (unsigned short * biggishint1, unsigned short * biggishint2);
-//unsigned short * biggishintBitwiseNot            (unsigned short * biggishint);
-//unsigned short * biggishintBitwiseOr             (unsigned short * biggishint1, unsigned short * biggishint2);
-//unsigned short * biggishintBitwiseXor            (unsigned short * biggishint1, unsigned short * biggishint2);
+unsigned long    biggishintAllocations           (void);
+unsigned short * biggishintBitwiseAnd            (unsigned short * biggishint1, unsigned short * biggishint2);
+unsigned short * biggishintBitwiseNot            (unsigned short * biggishint);
+unsigned short * biggishintBitwiseOr             (unsigned short * biggishint1, unsigned short * biggishint2);
+unsigned short * biggishintBitwiseXor            (unsigned short * biggishint1, unsigned short * biggishint2);
 //unsigned short * biggishintBooleanAnd            (unsigned short * biggishint1, unsigned short * biggishint2);
 //unsigned short * biggishintBooleanNot            (unsigned short * biggishint);
 //unsigned short * biggishintBooleanOr             (unsigned short * biggishint1, unsigned short * biggishint2);
@@ -14,17 +15,31 @@ int              biggishintCompare               (unsigned short * biggishint1,
 //void             biggishintDecrement             (unsigned short * biggishint);
 unsigned short * biggishintDivide                (unsigned short * biggishint1, unsigned short * biggishint2);
 void             biggishintFree                  (unsigned short * biggishint1);
+void             biggishintFreeBatch             (unsigned short ** biggishints, int count);
+unsigned short * biggishintFromBytes             (unsigned char * bytes, long bytecount, int negative);
 unsigned short * biggishintFromDecimalString     (char * str);
+int              biggishintFromDecimalStringBatch(unsigned short ** results, char * str, int count);
 unsigned short * biggishintFromHexadecimalString (char * str);
 unsigned short * biggishintFromLong              (long l);
+unsigned short * biggishintGreatestCommonDivisor (unsigned short * biggishint1, unsigned short * biggishint2);
 //void             biggishintIncrement             (unsigned short * biggishint);
-//unsigned short * biggishintModulo                (unsigned short * biggishint1, unsigned short * biggishint2);
+const char     * biggishintKernels               (char * name);
+unsigned short * biggishintModulo                (unsigned short * biggishint1, unsigned short * biggishint2);
 unsigned short * biggishintMultiply              (unsigned short * biggishint1, unsigned short * biggishint2);
-//unsigned short * biggishintPower                 (unsigned short * biggishint1, unsigned short * biggishint2);
+void             biggishintMultiplyBatch         (unsigned short ** results, unsigned short ** biggishints1, unsigned short ** biggishints2, int count);
+unsigned short * biggishintPower                 (unsigned short * biggishint1, unsigned short * biggishint2);
+unsigned short * biggishintPowerModulo           (unsigned short * biggishint1, unsigned short * biggishint2, unsigned short * biggishint3);
+void             biggishintReleaseCache          (void);
 unsigned short * biggishintShiftLeft             (unsigned short * biggishint1, unsigned short * biggishint2);
 unsigned short * biggishintShiftRight            (unsigned short * biggishint1, unsigned short * biggishint2);
+int              biggishintSign                  (unsigned short * biggishint);
 unsigned short * biggishintSubtract              (unsigned short * biggishint1, unsigned short * biggishint2);
+unsigned short * biggishintSumBatch              (unsigned short ** biggishints, int count);
+int              biggishintThreads               (int threads);
+long             biggishintToBytes               (unsigned short * biggishint, unsigned char * bytes, long bytecount);
 char           * biggishintToDecimalString       (unsigned short * biggishint);
+char           * biggishintToDecimalStringBatch  (unsigned short ** biggishints, int count);
 char           * biggishintToHexadecimalString   (unsigned short * biggishint);
+char           * biggishintToHexadecimalStringBatch(unsigned short ** biggishints, int count);
 /*                                               ^ no, you can't do this in Perl 6! */
 /* end of biggishint.h */
@@ -0,0 +1,162 @@
+/* biggishrat-test.c */
+/* Tests of the biggishrat library: known values, reduction to lowest */
+/* terms, and identities on random fractions too big for any built in */
+/* type.  The output is TAP. */
+
+/* To build and run on Linux: */
+/*   cc -O2 -o biggishrat-test biggishrat-test.c biggishrat.c biggishint.c */
+/*   ./biggishrat-test */
+/* or with prove: prove -e '' ./biggishrat-test */
+
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* free rand */
+#include <string.h>  /* strcmp */
+#include "biggishint.h"
+#include "biggishrat.h"
+
+/* How many random fractions for the identities, and their size */
+#define TEST_CASES 50
+#define TEST_DIGITS 300
+
+static int test_number = 0;
+
+
+/* test_ok */
+static void
+test_ok(int ok, const char * description)
+{
+    printf("%sok %d - %s\n", ok ? "" : "not ", ++test_number, description);
+}
+
+
+/* test_string */
+/* Checks the string form of br1, and frees br1 */
+static void
+test_string(biggishrat * br1, const char * want, const char * description)
+{
+    char * got = biggishratToDecimalString(br1);
+    test_ok(strcmp(got, want) == 0, description);
+    if (strcmp(got, want))
+        printf("#   expected %s\n#   got      %s\n", want, got);
+    free(got);
+    biggishratFree(br1);
+}
+
+
+/* test_random */
+/* A random fraction of up to TEST_DIGITS digits over up to */
+/* TEST_DIGITS digits, never 0 */
+static biggishrat *
+test_random(void)
+{
+    char str[2 * TEST_DIGITS + 4], * p = str;
+    int i, digits;
+    if (rand() % 2)
+        * p++ = '-';
+    digits = rand() % TEST_DIGITS + 1;
+    for (i=0; i<digits; ++i)
+        * p++ = '1' + rand() % 9;  /* no zeros, so never 0 */
+    * p++ = '/';
+    digits = rand() % TEST_DIGITS + 1;
+    for (i=0; i<digits; ++i)
+        * p++ = '1' + rand() % 9;
+    * p = '\0';
+    return biggishratFromDecimalString(str);
+}
+
+
+int
+main(void)
+{
+    biggishrat * br1, * br2, * br3, * br4, * sum, * term;
+    unsigned short * bi1;
+    int c, k, ok;
+    char * s;
+    printf("1..13\n");
+
+    test_string(biggishratFromDecimalString("6/-4"), "-3/2", "reduced with the sign on top");
+    test_string(biggishratFromDecimalString("0/-5"), "0/1", "zero");
+    test_string(biggishratFromDecimalString("42"), "42/1", "integer");
+    test_ok(biggishratFromDecimalString("1/0") == NULL, "zero denominator");
+
+    br1 = biggishratFromLongs(1, 3);
+    br2 = biggishratFromLongs(-1, 2);
+    br3 = biggishratFromLongs(0, 1);
+    test_ok(biggishratDivide(br1, br3) == NULL, "division by zero");
+    test_ok(biggishratCompare(br2, br1) < 0 && biggishratCompare(br1, br2) > 0
+        && biggishratCompare(br1, br1) == 0, "compare");
+    test_string(biggishratSubtract(br1, br2), "5/6", "subtract");
+    test_string(biggishratDivide(br1, br2), "-2/3", "divide");
+    biggishratFree(br1); biggishratFree(br2); biggishratFree(br3);
+
+    /* The harmonic number H(100), summed lazily */
+    sum = biggishratFromLongs(0, 1);
+    for (k=1; k<=100; ++k) {
+        term = biggishratFromLongs(1, k);
+        br1 = biggishratAdd(sum, term);
+        biggishratFree(sum); biggishratFree(term);
+        sum = br1;
+    }
+    test_string(sum, "14466636279520351160221518043104131447711/"
+        "2788815009188499086581352357412492142272", "harmonic number");
+
+    /* 1/(1*2) + 1/(2*3) + ... + 1/(n*(n+1)) telescopes to n/(n+1) */
+    sum = biggishratFromLongs(0, 1);
+    for (k=1; k<=1000; ++k) {
+        term = biggishratFromLongs(1, (long) k * (k + 1));
+        br1 = biggishratAdd(sum, term);
+        biggishratFree(sum); biggishratFree(term);
+        sum = br1;
+    }
+    test_string(sum, "1000/1001", "telescoping sum");
+
+    /* Numerator and denominator come out in lowest terms */
+    br1 = biggishratFromLongs(-10, 4);
+    bi1 = biggishratNumerator(br1);
+    s = biggishintToDecimalString(bi1);
+    ok = strcmp(s, "-5") == 0;
+    free(s); biggishintFree(bi1);
+    bi1 = biggishratDenominator(br1);
+    s = biggishintToDecimalString(bi1);
+    test_ok(ok && strcmp(s, "2") == 0 && biggishratSign(br1) < 0, "numerator and denominator");
+    free(s); biggishintFree(bi1);
+    biggishratFree(br1);
+
+    /* Identities on big random fractions */
+    ok = 1;
+    for (c=0; c<TEST_CASES; ++c) {
+        br1 = test_random();
+        br2 = test_random();
+        br3 = biggishratAdd(br1, br2);
+        br4 = biggishratSubtract(br3, br2);
+        ok &= biggishratCompare(br4, br1) == 0;
+        biggishratFree(br3); biggishratFree(br4);
+        br3 = biggishratMultiply(br1, br2);
+        br4 = biggishratDivide(br3, br2);
+        ok &= biggishratCompare(br4, br1) == 0;
+        biggishratFree(br3); biggishratFree(br4);
+        biggishratFree(br1); biggishratFree(br2);
+    }
+    test_ok(ok, "(a + b) - b == a and (a * b) / b == a");
+
+    /* Comparison agrees with the sign of the difference */
+    ok = 1;
+    for (c=0; c<TEST_CASES; ++c) {
+        br1 = test_random();
+        if (c % 5) {
+            br2 = test_random();
+        }
+        else {  /* sometimes an equal one */
+            s = biggishratToDecimalString(br1);
+            br2 = biggishratFromDecimalString(s);
+            free(s);
+        }
+        br3 = biggishratSubtract(br1, br2);
+        ok &= biggishratCompare(br1, br2) == biggishratSign(br3);
+        biggishratFree(br1); biggishratFree(br2); biggishratFree(br3);
+    }
+    test_ok(ok, "compare and sign of the difference");
+    return 0;
+}
+
+/* end of biggishrat-test.c */
@@ -0,0 +1,354 @@
+/* biggishrat.c */
+/* Biggish rationals are exact fractions of two biggishints, a */
+/* numerator and a denominator, for arithmetic without rounding.  They */
+/* use only the public functions of biggishint.c, so the two are */
+/* linked together (see biggishrat.pl6 for how). */
+
+/* The numerator carries the sign, and the denominator is always */
+/* greater than 0.  A biggishrat is not kept in lowest terms after */
+/* every operation, because the greatest common divisor costs far more */
+/* than the additions and multiplications themselves, and a chain of */
+/* additions would pay for it every step.  Instead the terms are */
+/* reduced lazily: when the denominator has grown to more than twice */
+/* its size at the last reduction (plus BIGGISHRAT_LAZY_BYTES), when */
+/* the value is read out with biggishratNumerator, */
+/* biggishratDenominator or biggishratToDecimalString, or when the */
+/* caller asks with biggishratNormalize.  The value is the same either */
+/* way, so reducing one is not a change as far as the caller can see. */
+
+/* Adding two biggishrats with equal denominators only adds the */
+/* numerators, so sums of integers or of fractions over the same */
+/* denominator never multiply at all. */
+
+/* Like biggishint, every function returns a new biggishrat (or */
+/* biggishint or string) and leaves its arguments alone, apart from */
+/* reducing them.  Division by zero returns NULL. */
+
+/* Use biggishrat at your risk and without warranty.  Give due credit */
+/* if you do. */
+
+#include <assert.h>  /* assert */
+#include <stdlib.h>  /* malloc free */
+#include <string.h>  /* strchr strlen memcpy */
+#include "biggishint.h"  /* everything biggishrat works with */
+#include "biggishrat.h"  /* (all externally callable functions) */
+
+/* How many bytes a denominator may grow by, beyond doubling, before */
+/* it is reduced without being asked */
+#define BIGGISHRAT_LAZY_BYTES 32
+
+struct biggishrat {
+    unsigned short * numerator;     /* has the sign of the rational */
+    unsigned short * denominator;   /* always greater than 0 */
+    long             reducedbytes;  /* denominator size when last reduced */
+    int              reduced;       /* known to be in lowest terms */
+};
+
+/* Internal functions are declared here, their definitions are lower */
+/* down. */
+biggishrat     * biggishrat_internal_addsubtract(biggishrat * br1, biggishrat * br2, int subtract);
+unsigned short * biggishrat_internal_copy(unsigned short * bi1);
+int              biggishrat_internal_isone(unsigned short * bi1);
+unsigned short * biggishrat_internal_negate(unsigned short * bi1);
+biggishrat     * biggishrat_internal_new(unsigned short * numerator, unsigned short * denominator, long reducedbytes);
+
+
+/* --------------------------- Functions ---------------------------- */
+
+/* biggishratAdd */
+biggishrat *
+biggishratAdd(biggishrat * br1, biggishrat * br2)
+{
+    return biggishrat_internal_addsubtract(br1, br2, 0);
+}
+
+
+/* biggishratCompare */
+/* Returns -1, 0 or 1 like biggishintCompare, by cross multiplying */
+/* unless the signs or the denominators already decide it */
+int
+biggishratCompare(biggishrat * br1, biggishrat * br2)
+{
+    int sign1, sign2, result;
+    unsigned short * cross1, * cross2;
+    sign1 = biggishintSign(br1->numerator);
+    sign2 = biggishintSign(br2->numerator);
+    if (sign1 != sign2)
+        return sign1 < sign2 ? -1 : 1;
+    if (biggishintCompare(br1->denominator, br2->denominator) == 0)
+        return biggishintCompare(br1->numerator, br2->numerator);
+    cross1 = biggishintMultiply(br1->numerator, br2->denominator);
+    cross2 = biggishintMultiply(br2->numerator, br1->denominator);
+    result = biggishintCompare(cross1, cross2);
+    biggishintFree(cross1);
+    biggishintFree(cross2);
+    return result;
+}
+
+
+/* biggishratDenominator */
+/* A new biggishint, in lowest terms, always greater than 0 */
+unsigned short *
+biggishratDenominator(biggishrat * br1)
+{
+    biggishratNormalize(br1);
+    return biggishrat_internal_copy(br1->denominator);
+}
+
+
+/* biggishratDivide */
+/* Returns NULL if br2 is 0 */
+biggishrat *
+biggishratDivide(biggishrat * br1, biggishrat * br2)
+{
+    unsigned short * numerator, * denominator;
+    int sign2;
+    sign2 = biggishintSign(br2->numerator);
+    if (sign2 == 0)
+        return NULL;
+    numerator   = biggishintMultiply(br1->numerator,   br2->denominator);
+    denominator = biggishintMultiply(br1->denominator, br2->numerator);
+    if (sign2 < 0) {
+        numerator   = biggishrat_internal_negate(numerator);
+        denominator = biggishrat_internal_negate(denominator);
+    }
+    return biggishrat_internal_new(numerator, denominator,
+        br1->reducedbytes > br2->reducedbytes ? br1->reducedbytes : br2->reducedbytes);
+}
+
+
+/* biggishratFree */
+void
+biggishratFree(biggishrat * br1)
+{
+    biggishintFree(br1->numerator);
+    biggishintFree(br1->denominator);
+    free(br1);
+}
+
+
+/* biggishratFromBiggishints */
+/* Copies the numerator and denominator, returns NULL if the */
+/* denominator is 0 */
+biggishrat *
+biggishratFromBiggishints(unsigned short * numerator, unsigned short * denominator)
+{
+    int sign;
+    sign = biggishintSign(denominator);
+    if (sign == 0)
+        return NULL;
+    if (sign < 0)
+        return biggishrat_internal_new(biggishrat_internal_negate(biggishrat_internal_copy(numerator)),
+            biggishrat_internal_negate(biggishrat_internal_copy(denominator)), 0);
+    return biggishrat_internal_new(biggishrat_internal_copy(numerator),
+        biggishrat_internal_copy(denominator), 0);
+}
+
+
+/* biggishratFromDecimalString */
+/* Reads an integer such as "-12" or a fraction such as "-12/34", and */
+/* returns NULL if the denominator is 0 */
+biggishrat *
+biggishratFromDecimalString(char * str)
+{
+    unsigned short * numerator, * denominator;
+    biggishrat * br1;
+    char * slash;
+    numerator = biggishintFromDecimalString(str);
+    slash = strchr(str, '/');
+    denominator = slash ? biggishintFromDecimalString(slash + 1) : biggishintFromLong(1);
+    br1 = biggishratFromBiggishints(numerator, denominator);
+    biggishintFree(numerator);
+    biggishintFree(denominator);
+    return br1;
+}
+
+
+/* biggishratFromLongs */
+/* Returns NULL if the denominator is 0 */
+biggishrat *
+biggishratFromLongs(long numerator, long denominator)
+{
+    unsigned short * bi1, * bi2;
+    biggishrat * br1;
+    bi1 = biggishintFromLong(numerator);
+    bi2 = biggishintFromLong(denominator);
+    br1 = biggishratFromBiggishints(bi1, bi2);
+    biggishintFree(bi1);
+    biggishintFree(bi2);
+    return br1;
+}
+
+
+/* biggishratMultiply */
+biggishrat *
+biggishratMultiply(biggishrat * br1, biggishrat * br2)
+{
+    return biggishrat_internal_new(
+        biggishintMultiply(br1->numerator,   br2->numerator),
+        biggishintMultiply(br1->denominator, br2->denominator),
+        br1->reducedbytes > br2->reducedbytes ? br1->reducedbytes : br2->reducedbytes);
+}
+
+
+/* biggishratNormalize */
+/* Reduces br1 to lowest terms, if it is not known to be already */
+void
+biggishratNormalize(biggishrat * br1)
+{
+    unsigned short * divisor, * quotient;
+    if (br1->reduced)
+        return;
+    divisor = biggishintGreatestCommonDivisor(br1->numerator, br1->denominator);
+    if (! biggishrat_internal_isone(divisor)) {
+        quotient = biggishintDivide(br1->numerator, divisor);
+        biggishintFree(br1->numerator);
+        br1->numerator = quotient;
+        quotient = biggishintDivide(br1->denominator, divisor);
+        biggishintFree(br1->denominator);
+        br1->denominator = quotient;
+    }
+    biggishintFree(divisor);
+    br1->reducedbytes = biggishintToBytes(br1->denominator, NULL, 0);
+    br1->reduced = 1;
+}
+
+
+/* biggishratNumerator */
+/* A new biggishint, in lowest terms, with the sign of br1 */
+unsigned short *
+biggishratNumerator(biggishrat * br1)
+{
+    biggishratNormalize(br1);
+    return biggishrat_internal_copy(br1->numerator);
+}
+
+
+/* biggishratSign */
+/* Returns -1, 0 or 1 as br1 is negative, zero or positive */
+int
+biggishratSign(biggishrat * br1)
+{
+    return biggishintSign(br1->numerator);
+}
+
+
+/* biggishratSubtract */
+biggishrat *
+biggishratSubtract(biggishrat * br1, biggishrat * br2)
+{
+    return biggishrat_internal_addsubtract(br1, br2, 1);
+}
+
+
+/* biggishratToDecimalString */
+/* Always numerator/denominator in lowest terms, such as "-3/4" or */
+/* "5/1", so that biggishratFromDecimalString can read it back */
+char *
+biggishratToDecimalString(biggishrat * br1)
+{
+    char * numerator, * denominator, * result;
+    size_t numeratorlength;
+    biggishratNormalize(br1);
+    numerator   = biggishintToDecimalString(br1->numerator);
+    denominator = biggishintToDecimalString(br1->denominator);
+    numeratorlength = strlen(numerator);
+    result = (char *) malloc(numeratorlength + strlen(denominator) + 2);
+    assert( result != NULL );
+    memcpy(result, numerator, numeratorlength);
+    result[numeratorlength] = '/';
+    strcpy(result + numeratorlength + 1, denominator);
+    free(numerator);
+    free(denominator);
+    return result;
+}
+
+
+/* ----------------------- Internal functions ----------------------- */
+
+/* biggishrat_internal_addsubtract */
+/* br1 + br2, or br1 - br2 if subtract is set.  Equal denominators */
+/* need no multiplications. */
+biggishrat *
+biggishrat_internal_addsubtract(biggishrat * br1, biggishrat * br2, int subtract)
+{
+    unsigned short * (* addsubtract)(unsigned short *, unsigned short *);
+    unsigned short * numerator, * denominator, * cross1, * cross2;
+    addsubtract = subtract ? biggishintSubtract : biggishintAdd;
+    if (biggishintCompare(br1->denominator, br2->denominator) == 0) {
+        numerator   = addsubtract(br1->numerator, br2->numerator);
+        denominator = biggishrat_internal_copy(br1->denominator);
+    }
+    else {
+        cross1      = biggishintMultiply(br1->numerator, br2->denominator);
+        cross2      = biggishintMultiply(br2->numerator, br1->denominator);
+        numerator   = addsubtract(cross1, cross2);
+        denominator = biggishintMultiply(br1->denominator, br2->denominator);
+        biggishintFree(cross1);
+        biggishintFree(cross2);
+    }
+    return biggishrat_internal_new(numerator, denominator,
+        br1->reducedbytes > br2->reducedbytes ? br1->reducedbytes : br2->reducedbytes);
+}
+
+
+/* biggishrat_internal_copy */
+unsigned short *
+biggishrat_internal_copy(unsigned short * bi1)
+{
+    unsigned short * zero, * copy;
+    zero = biggishintFromLong(0);
+    copy = biggishintAdd(bi1, zero);
+    biggishintFree(zero);
+    return copy;
+}
+
+
+/* biggishrat_internal_isone */
+int
+biggishrat_internal_isone(unsigned short * bi1)
+{
+    unsigned short * one;
+    int result;
+    one = biggishintFromLong(1);
+    result = biggishintCompare(bi1, one) == 0;
+    biggishintFree(one);
+    return result;
+}
+
+
+/* biggishrat_internal_negate */
+/* Frees bi1 and returns -bi1 */
+unsigned short *
+biggishrat_internal_negate(unsigned short * bi1)
+{
+    unsigned short * zero, * negative;
+    zero = biggishintFromLong(0);
+    negative = biggishintSubtract(zero, bi1);
+    biggishintFree(zero);
+    biggishintFree(bi1);
+    return negative;
+}
+
+
+/* biggishrat_internal_new */
+/* Takes over the numerator and (positive) denominator, and reduces */
+/* the new biggishrat if the denominator has grown too much since the */
+/* operands were last reduced.  That is the lazy part. */
+biggishrat *
+biggishrat_internal_new(unsigned short * numerator, unsigned short * denominator, long reducedbytes)
+{
+    biggishrat * br1;
+    br1 = (biggishrat *) malloc(sizeof(biggishrat));
+    assert( br1 != NULL );
+    br1->numerator    = numerator;
+    br1->denominator  = denominator;
+    br1->reducedbytes = reducedbytes;
+    br1->reduced      = biggishrat_internal_isone(denominator);
+    if (! br1->reduced && biggishintToBytes(denominator, NULL, 0)
+            > 2 * reducedbytes + BIGGISHRAT_LAZY_BYTES)
+        biggishratNormalize(br1);
+    return br1;
+}
+
+/* end of biggishrat.c */
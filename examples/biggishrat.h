@@ -0,0 +1,20 @@
+/* biggishrat.h */
+
+/* A biggishrat is opaque, pass it around by pointer only */
+typedef struct biggishrat biggishrat;
+
+biggishrat     * biggishratAdd                   (biggishrat * biggishrat1, biggishrat * biggishrat2);
+int              biggishratCompare               (biggishrat * biggishrat1, biggishrat * biggishrat2);
+unsigned short * biggishratDenominator           (biggishrat * biggishrat1);
+biggishrat     * biggishratDivide                (biggishrat * biggishrat1, biggishrat * biggishrat2);
+void             biggishratFree                  (biggishrat * biggishrat1);
+biggishrat     * biggishratFromBiggishints       (unsigned short * numerator, unsigned short * denominator);
+biggishrat     * biggishratFromDecimalString     (char * str);
+biggishrat     * biggishratFromLongs             (long numerator, long denominator);
+biggishrat     * biggishratMultiply              (biggishrat * biggishrat1, biggishrat * biggishrat2);
+void             biggishratNormalize             (biggishrat * biggishrat1);
+unsigned short * biggishratNumerator             (biggishrat * biggishrat1);
+int              biggishratSign                  (biggishrat * biggishrat1);
+biggishrat     * biggishratSubtract              (biggishrat * biggishrat1, biggishrat * biggishrat2);
+char           * biggishratToDecimalString       (biggishrat * biggishrat1);
+/* end of biggishrat.h */
@@ -0,0 +1,176 @@
+/* carrayops-test.c */
+/* Tests of carrayops.c against simple loops, for every length up to */
+/* a few times the width of the vector loops, so that every tail is */
+/* covered.  The output is TAP. */
+
+/* To build and run on Linux: */
+/*   cc -O3 -march=native -o carrayops-test carrayops-test.c carrayops.c */
+/*   ./carrayops-test */
+/* or with prove: prove -e '' ./carrayops-test */
+
+#include <stdio.h>   /* printf */
+#include <stdlib.h>  /* rand */
+#include <string.h>  /* memcpy */
+#include <math.h>    /* fabs */
+
+#define TEST_LENGTH 100
+
+double    carrayops_sum_num64  (const double * a, long n);
+double    carrayops_min_num64  (const double * a, long n);
+double    carrayops_max_num64  (const double * a, long n);
+double    carrayops_dot_num64  (const double * a, const double * b, long n);
+void      carrayops_scale_num64(double * a, long n, double factor);
+void      carrayops_add_num64  (const double * a, const double * b, double * out, long n);
+long      carrayops_above_num64(const double * a, long n, double threshold, char * mask);
+double    carrayops_sum_num32  (const float * a, long n);
+float     carrayops_min_num32  (const float * a, long n);
+double    carrayops_dot_num32  (const float * a, const float * b, long n);
+long long carrayops_sum_int32  (const int * a, long n);
+int       carrayops_max_int32  (const int * a, long n);
+long long carrayops_dot_int32  (const int * a, const int * b, long n);
+void      carrayops_scale_int32(int * a, long n, long long factor);
+long      carrayops_above_int32(const int * a, long n, long long threshold, char * mask);
+long long carrayops_sum_int64  (const long long * a, long n);
+long long carrayops_min_int64  (const long long * a, long n);
+void      carrayops_add_int64  (const long long * a, const long long * b, long long * out, long n);
+
+static int test_number = 0;
+
+
+/* test_ok */
+static void
+test_ok(int ok, const char * description)
+{
+    printf("%sok %d - %s\n", ok ? "" : "not ", ++test_number, description);
+}
+
+
+/* close_to */
+static int
+close_to(double got, double want)
+{
+    return fabs(got - want) <= 1e-9 * (fabs(want) + 1);
+}
+
+
+/* main */
+int
+main(void)
+{
+    double d1[TEST_LENGTH], d2[TEST_LENGTH], dout[TEST_LENGTH], want, want2;
+    float f1[TEST_LENGTH], f2[TEST_LENGTH];
+    int i1[TEST_LENGTH], i2[TEST_LENGTH];
+    long long l1[TEST_LENGTH], l2[TEST_LENGTH], lout[TEST_LENGTH], lwant;
+    char mask[TEST_LENGTH];
+    long n, i, count;
+    int ok[18];
+    for (i=0; i<18; ++i)
+        ok[i] = 1;
+    srand(42);
+    for (i=0; i<TEST_LENGTH; ++i) {
+        d1[i] = rand() / (double) RAND_MAX - 0.5;
+        d2[i] = rand() / (double) RAND_MAX * 4 - 2;
+        f1[i] = (float) d1[i];
+        f2[i] = (float) d2[i];
+        i1[i] = rand() % 2001 - 1000;
+        i2[i] = rand() % 2001 - 1000;
+        l1[i] = ((long long) rand() << 20) - ((long long) RAND_MAX << 19);
+        l2[i] = ((long long) rand() << 20) - ((long long) RAND_MAX << 19);
+    }
+    printf("1..18\n");
+    for (n=0; n<=TEST_LENGTH; ++n) {
+        /* num64 */
+        for (want=0, i=0; i<n; ++i)
+            want += d1[i];
+        ok[0] &= close_to(carrayops_sum_num64(d1, n), want);
+        for (want=0, want2=0, i=0; i<n; ++i) {
+            if (i == 0 || d1[i] < want)
+                want = d1[i];
+            if (i == 0 || d1[i] > want2)
+                want2 = d1[i];
+        }
+        ok[1] &= carrayops_min_num64(d1, n) == want;
+        ok[2] &= carrayops_max_num64(d1, n) == want2;
+        for (want=0, i=0; i<n; ++i)
+            want += d1[i] * d2[i];
+        ok[3] &= close_to(carrayops_dot_num64(d1, d2, n), want);
+        memcpy(dout, d1, sizeof(dout));
+        carrayops_scale_num64(dout, n, -2.5);
+        for (i=0; i<TEST_LENGTH; ++i)
+            ok[4] &= dout[i] == (i < n ? d1[i] * -2.5 : d1[i]);
+        carrayops_add_num64(d1, d2, dout, n);
+        for (i=0; i<n; ++i)
+            ok[5] &= dout[i] == d1[i] + d2[i];
+        memcpy(dout, d1, sizeof(dout));
+        carrayops_add_num64(dout, d2, dout, n);
+        for (i=0; i<n; ++i)
+            ok[6] &= dout[i] == d1[i] + d2[i];
+        for (count=0, i=0; i<n; ++i)
+            count += d1[i] > 0.25;
+        ok[7] &= carrayops_above_num64(d1, n, 0.25, NULL) == count;
+        ok[8] &= carrayops_above_num64(d1, n, 0.25, mask) == count;
+        for (i=0; i<n; ++i)
+            ok[8] &= mask[i] == (d1[i] > 0.25);
+        /* num32 */
+        for (want=0, i=0; i<n; ++i)
+            want += f1[i];
+        ok[9] &= close_to(carrayops_sum_num32(f1, n), want);
+        for (want=0, i=0; i<n; ++i)
+            if (i == 0 || f1[i] < want)
+                want = f1[i];
+        ok[10] &= carrayops_min_num32(f1, n) == (float) want;
+        for (want=0, i=0; i<n; ++i)
+            want += (double) f1[i] * f2[i];
+        ok[11] &= close_to(carrayops_dot_num32(f1, f2, n), want);
+        /* int32 */
+        for (lwant=0, i=0; i<n; ++i)
+            lwant += i1[i];
+        ok[12] &= carrayops_sum_int32(i1, n) == lwant;
+        for (lwant=0, i=0; i<n; ++i)
+            if (i == 0 || i1[i] > lwant)
+                lwant = i1[i];
+        ok[13] &= carrayops_max_int32(i1, n) == lwant;
+        for (lwant=0, i=0; i<n; ++i)
+            lwant += (long long) i1[i] * i2[i];
+        ok[14] &= carrayops_dot_int32(i1, i2, n) == lwant;
+        memcpy(i2, i1, sizeof(i2));
+        carrayops_scale_int32(i2, n, -3);
+        for (count=0, i=0; i<n; ++i) {
+            ok[15] &= i2[i] == i1[i] * -3;
+            count += i1[i] > 100;
+        }
+        ok[15] &= carrayops_above_int32(i1, n, 100, mask) == count;
+        /* int64 */
+        for (lwant=0, i=0; i<n; ++i)
+            lwant += l1[i];
+        ok[16] &= carrayops_sum_int64(l1, n) == lwant;
+        for (lwant=0, i=0; i<n; ++i)
+            if (i == 0 || l1[i] < lwant)
+                lwant = l1[i];
+        ok[16] &= carrayops_min_int64(l1, n) == lwant;
+        carrayops_add_int64(l1, l2, lout, n);
+        for (i=0; i<n; ++i)
+            ok[17] &= lout[i] == l1[i] + l2[i];
+    }
+    test_ok(ok[0],  "sum num64");
+    test_ok(ok[1],  "min num64");
+    test_ok(ok[2],  "max num64");
+    test_ok(ok[3],  "dot num64");
+    test_ok(ok[4],  "scale num64, only n elements");
+    test_ok(ok[5],  "add num64");
+    test_ok(ok[6],  "add num64 in place");
+    test_ok(ok[7],  "above num64, count only");
+    test_ok(ok[8],  "above num64, with mask");
+    test_ok(ok[9],  "sum num32, in double");
+    test_ok(ok[10], "min num32");
+    test_ok(ok[11], "dot num32, in double");
+    test_ok(ok[12], "sum int32, in long long");
+    test_ok(ok[13], "max int32");
+    test_ok(ok[14], "dot int32, in long long");
+    test_ok(ok[15], "scale and above int32");
+    test_ok(ok[16], "sum and min int64");
+    test_ok(ok[17], "add int64");
+    return 0;
+}
+
+/* end of carrayops-test.c */
@@ -0,0 +1,129 @@
+/* carrayops.c */
+/* Reductions and elementwise operations on the C arrays behind Perl 6 */
+/* CArrays of numbers, each done in one NativeCall crossing instead of */
+/* one at_pos per element.  See CArrayOps.pm, which picks the function */
+/* for the element type of a CArray. */
+
+/* For each element type there are: */
+/*   carrayops_sum_T     (a, n)                  sum of a[0..n-1] */
+/*   carrayops_min_T     (a, n)                  smallest element, 0 if n < 1 */
+/*   carrayops_max_T     (a, n)                  largest element, 0 if n < 1 */
+/*   carrayops_dot_T     (a, b, n)               sum of a[i] * b[i] */
+/*   carrayops_scale_T   (a, n, factor)          a[i] *= factor, in place */
+/*   carrayops_add_T     (a, b, out, n)          out[i] = a[i] + b[i], out may be a or b */
+/*   carrayops_above_T   (a, n, threshold, mask) how many a[i] > threshold, and */
+/*                                               mask[i] = 1 or 0 for each if mask */
+/*                                               is not NULL */
+/* with T one of num64 (double), num32 (float), int32 (int) and int64 */
+/* (long long).  Sums and dot products are double for the floating */
+/* types and long long for the integer ones.  Integer results must fit */
+/* their type, overflow is not checked. */
+
+/* The loops are written so that the compiler can vectorize them: the */
+/* reductions keep eight independent partial results, which also means */
+/* a floating sum is added in a different order than a simple loop */
+/* would, and may differ from it in the last bits.  A NaN is skipped by */
+/* min and max unless it is the first element. */
+
+/* To build on Linux: */
+/*   cc -O3 -march=native -fPIC -shared -o carrayops.so carrayops.c */
+
+#include <stddef.h>  /* NULL */
+
+#define CARRAYOPS_LANES 8
+
+#define CARRAYOPS_DEFINE(NAME, T, ACC)                                          \
+                                                                                \
+ACC                                                                             \
+carrayops_sum_##NAME(const T * a, long n)                                       \
+{                                                                               \
+    ACC partial[CARRAYOPS_LANES] = { 0 }, sum = 0;                              \
+    long i, lane;                                                               \
+    for (i=0; i + CARRAYOPS_LANES <= n; i += CARRAYOPS_LANES)                   \
+        for (lane=0; lane<CARRAYOPS_LANES; ++lane)                              \
+            partial[lane] += a[i + lane];                                       \
+    for (lane=0; lane<CARRAYOPS_LANES; ++lane)                                  \
+        sum += partial[lane];                                                   \
+    for (; i<n; ++i)                                                            \
+        sum += a[i];                                                            \
+    return sum;                                                                 \
+}                                                                               \
+                                                                                \
+T                                                                               \
+carrayops_min_##NAME(const T * a, long n)                                       \
+{                                                                               \
+    T min;                                                                      \
+    long i;                                                                     \
+    if (n < 1)                                                                  \
+        return 0;                                                               \
+    for (min=a[0], i=1; i<n; ++i)                                               \
+        min = a[i] < min ? a[i] : min;                                          \
+    return min;                                                                 \
+}                                                                               \
+                                                                                \
+T                                                                               \
+carrayops_max_##NAME(const T * a, long n)                                       \
+{                                                                               \
+    T max;                                                                      \
+    long i;                                                                     \
+    if (n < 1)                                                                  \
+        return 0;                                                               \
+    for (max=a[0], i=1; i<n; ++i)                                               \
+        max = a[i] > max ? a[i] : max;                                          \
+    return max;                                                                 \
+}                                                                               \
+                                                                                \
+ACC                                                                             \
+carrayops_dot_##NAME(const T * a, const T * b, long n)                          \
+{                                                                               \
+    ACC partial[CARRAYOPS_LANES] = { 0 }, sum = 0;                              \
+    long i, lane;                                                               \
+    for (i=0; i + CARRAYOPS_LANES <= n; i += CARRAYOPS_LANES)                   \
+        for (lane=0; lane<CARRAYOPS_LANES; ++lane)                              \
+            partial[lane] += (ACC) a[i + lane] * b[i + lane];                   \
+    for (lane=0; lane<CARRAYOPS_LANES; ++lane)                                  \
+        sum += partial[lane];                                                   \
+    for (; i<n; ++i)                                                            \
+        sum += (ACC) a[i] * b[i];                                               \
+    return sum;                                                                 \
+}                                                                               \
+                                                                                \
+void                                                                            \
+carrayops_scale_##NAME(T * a, long n, ACC factor)                               \
+{                                                                               \
+    long i;                                                                     \
+    for (i=0; i<n; ++i)                                                         \
+        a[i] = (T) (a[i] * factor);                                             \
+}                                                                               \
+                                                                                \
+void                                                                            \
+carrayops_add_##NAME(const T * a, const T * b, T * out, long n)                 \
+{                                                                               \
+    long i;                                                                     \
+    for (i=0; i<n; ++i)                                                         \
+        out[i] = a[i] + b[i];                                                   \
+}                                                                               \
+                                                                                \
+long                                                                            \
+carrayops_above_##NAME(const T * a, long n, ACC threshold, char * mask)         \
+{                                                                               \
+    long i, count = 0;                                                          \
+    if (mask == NULL) {                                                         \
+        for (i=0; i<n; ++i)                                                     \
+            count += a[i] > threshold;                                          \
+    }                                                                           \
+    else {                                                                      \
+        for (i=0; i<n; ++i) {                                                   \
+            mask[i] = a[i] > threshold;                                         \
+            count += mask[i];                                                   \
+        }                                                                       \
+    }                                                                           \
+    return count;                                                               \
+}
+
+CARRAYOPS_DEFINE(num64, double,    double)
+CARRAYOPS_DEFINE(num32, float,     double)
+CARRAYOPS_DEFINE(int32, int,       long long)
+CARRAYOPS_DEFINE(int64, long long, long long)
+
+/* end of carrayops.c */
@@ -0,0 +1,86 @@
+/* chain-test.c */
+/* Tests of chain.c.  The output is TAP. */
+
+/* To build and run on Linux: */
+/*   cc -O2 -o chain-test chain-test.c chain.c */
+/*   ./chain-test */
+/* or with prove: prove -e '' ./chain-test */
+
+#include <stdio.h>   /* printf */
+#include <stddef.h>  /* NULL, offsetof */
+#include <stdint.h>  /* intptr_t */
+
+long chain_collect(const char * head, long next_offset, long max, long long * out, long from);
+long chain_null_terminated_length(const void * const * array, long from, long max);
+
+typedef struct Node {
+    int          value;
+    struct Node *next;
+} Node;
+
+#define NODES 10
+
+static int test_number = 0;
+
+
+/* test_ok */
+static void
+test_ok(int ok, const char * description)
+{
+    printf("%sok %d - %s\n", ok ? "" : "not ", ++test_number, description);
+}
+
+
+/* address */
+static long long
+address(const void * p)
+{
+    return (long long) (intptr_t) p;
+}
+
+
+/* main */
+int
+main(void)
+{
+    Node nodes[NODES];
+    long long out[NODES + 1];
+    const char * strings[] = { "one", "two", "three", NULL };
+    long i, count;
+    int ok;
+
+    printf("1..12\n");
+    for (i=0; i<NODES; ++i) {
+        nodes[i].value = i;
+        nodes[i].next = i + 1 < NODES ? &nodes[i + 1] : NULL;
+    }
+
+    count = chain_collect((char *) &nodes[0], offsetof(Node, next), NODES, out, 0);
+    test_ok(count == NODES, "collects a whole list");
+    for (ok=1, i=0; i<NODES; ++i)
+        ok = ok && out[i] == address(&nodes[i]);
+    test_ok(ok, "in order");
+    test_ok(out[NODES] == 0, "with 0 after the end");
+
+    count = chain_collect((char *) &nodes[0], offsetof(Node, next), 4, out, 0);
+    test_ok(count == 4, "collects at most max nodes");
+    test_ok(out[4] == address(&nodes[4]), "with the next node after them");
+    count = chain_collect((char *) &nodes[4], offsetof(Node, next), 4, out, 4);
+    test_ok(count == 4 && out[4] == address(&nodes[4]), "and continues from it");
+    test_ok(out[3] == address(&nodes[3]) && out[8] == address(&nodes[8]),
+        "into out from where it is told");
+
+    count = chain_collect(NULL, offsetof(Node, next), NODES, out, 0);
+    test_ok(count == 0 && out[0] == 0, "an empty list has no nodes");
+
+    test_ok(chain_null_terminated_length((const void * const *) strings, 0, 100) == 3,
+        "length of a NULL terminated array");
+    test_ok(chain_null_terminated_length((const void * const *) strings, 0, 2) == 2,
+        "at most max");
+    test_ok(chain_null_terminated_length((const void * const *) strings, 1, 100) == 2,
+        "from an element on");
+    test_ok(chain_null_terminated_length(NULL, 0, 100) == 0, "of no array");
+    return 0;
+}
+
+/* end of chain-test.c */
@@ -0,0 +1,57 @@
+/* chain.c */
+/* Walks C linked lists and NULL terminated arrays of pointers in C, */
+/* many nodes per NativeCall crossing, for Chain.pm.  A node is any */
+/* struct with a pointer to the next one at a known byte offset. */
+
+/* chain_collect(head, next_offset, max, out, from) */
+/*   stores the addresses of up to max nodes, starting with head, in */
+/*   out[from..] and the address of the node after them, or 0 at the */
+/*   end of the list, in out[from + count]; out must have room for */
+/*   from + max + 1 addresses.  Returns count, the number of nodes */
+/*   stored. */
+/* chain_null_terminated_length(array, from, max) */
+/*   the number of pointers before the first NULL in array from */
+/*   array[from] on, at most max */
+
+/* The from arguments spare Perl 6 from working out the address of an */
+/* element, which takes the size of the elements. */
+
+/* Addresses are long long so that Perl 6 can read them as a */
+/* CArray[int64] whatever the size of a pointer. */
+
+/* To build on Linux: */
+/*   cc -O2 -fPIC -shared -o chain.so chain.c */
+
+#include <stddef.h>  /* NULL */
+#include <stdint.h>  /* intptr_t */
+
+
+/* chain_collect */
+long
+chain_collect(const char * head, long next_offset, long max, long long * out, long from)
+{
+    long count = 0;
+    out += from;
+    while (head != NULL && count < max) {
+        out[count++] = (long long) (intptr_t) head;
+        head = *(const char * const *) (head + next_offset);
+    }
+    out[count] = (long long) (intptr_t) head;
+    return count;
+}
+
+
+/* chain_null_terminated_length */
+long
+chain_null_terminated_length(const void * const * array, long from, long max)
+{
+    long length = 0;
+    if (array == NULL)
+        return 0;
+    array += from;
+    while (length < max && array[length] != NULL)
+        ++length;
+    return length;
+}
+
+/* end of chain.c */
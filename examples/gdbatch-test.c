@@ -0,0 +1,73 @@
+/* gdbatch-test.c */
+/* Tests of gdbatch.c, and of encoding to memory with gd.  The output */
+/* is TAP. */
+
+/* To build and run on Linux: */
+/*   cc -O2 -o gdbatch-test gdbatch-test.c gdbatch.c -lgd */
+/*   ./gdbatch-test */
+/* or with prove: prove -e '' ./gdbatch-test */
+
+#include <stdio.h>   /* printf */
+#include <string.h>  /* memcmp */
+#include <gd.h>
+
+long gdbatch_draw(gdImagePtr image, const int * commands, long count);
+
+static int test_number = 0;
+
+
+/* test_ok */
+static void
+test_ok(int ok, const char * description)
+{
+    printf("%sok %d - %s\n", ok ? "" : "not ", ++test_number, description);
+}
+
+
+/* main */
+int
+main(void)
+{
+    gdImagePtr image;
+    int black, white, size;
+    void * data;
+    int commands[] = {
+        0,  1,  1,  0,  0, 0,  /* pixel at 1, 1 */
+        1,  0, 10, 63, 10, 0,  /* line across at y 10 */
+        2, 20, 20, 30, 30, 0,  /* rectangle */
+        3, 40, 40, 50, 50, 0,  /* filled rectangle */
+        9,  0,  0,  0,  0, 0,  /* unknown */
+    };
+    int i;
+
+    printf("1..10\n");
+    image = gdImageCreate(64, 64);
+    black = gdImageColorAllocate(image, 0, 0, 0);
+    white = gdImageColorAllocate(image, 255, 255, 255);
+    for (i=0; i<5; ++i)
+        commands[6 * i + 5] = white;
+
+    test_ok(gdbatch_draw(image, commands, 4) == 4, "draws every command");
+    test_ok(gdImageGetPixel(image, 1, 1) == white, "a pixel");
+    test_ok(gdImageGetPixel(image, 2, 2) == black, "only that pixel");
+    test_ok(gdImageGetPixel(image, 33, 10) == white, "a line");
+    test_ok(gdImageGetPixel(image, 20, 25) == white
+         && gdImageGetPixel(image, 25, 25) == black, "a rectangle");
+    test_ok(gdImageGetPixel(image, 45, 45) == white, "a filled rectangle");
+    test_ok(gdbatch_draw(image, commands, 5) == 4, "stops at an unknown op");
+    test_ok(gdbatch_draw(image, commands, 0) == 0, "draws nothing");
+
+    data = gdImagePngPtr(image, &size);
+    test_ok(data != NULL && size > 8 && memcmp(data, "\211PNG", 4) == 0,
+        "encodes a PNG to memory");
+    gdFree(data);
+    data = gdImageJpegPtr(image, &size, -1);
+    test_ok(data != NULL && size > 2 && memcmp(data, "\377\330", 2) == 0,
+        "encodes a JPEG to memory");
+    gdFree(data);
+
+    gdImageDestroy(image);
+    return 0;
+}
+
+/* end of gdbatch-test.c */
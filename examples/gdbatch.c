@@ -0,0 +1,53 @@
+/* gdbatch.c */
+/* Draws a batch of lines, pixels and rectangles on a GD image in one */
+/* NativeCall crossing, for GD.pm.  The commands are packed in an array */
+/* of ints, GDBATCH_WIDTH for each: */
+/*   op, x1, y1, x2, y2, colour */
+/* with op one of the GDBATCH_ values below.  A pixel uses x1 and y1 */
+/* only, and the rectangles go from corner x1, y1 to corner x2, y2. */
+
+/* gdbatch_draw(image, commands, count) */
+/*   draws count commands and returns count, or the number drawn */
+/*   before the first with an unknown op */
+
+/* To build on Linux, with the development package of libgd installed: */
+/*   cc -O2 -fPIC -shared -o gdbatch.so gdbatch.c -lgd */
+
+#include <gd.h>
+
+#define GDBATCH_WIDTH            6
+
+#define GDBATCH_PIXEL            0
+#define GDBATCH_LINE             1
+#define GDBATCH_RECTANGLE        2
+#define GDBATCH_FILLED_RECTANGLE 3
+
+
+/* gdbatch_draw */
+long
+gdbatch_draw(gdImagePtr image, const int * commands, long count)
+{
+    long i;
+    const int * c;
+    for (i=0, c=commands; i<count; ++i, c += GDBATCH_WIDTH) {
+        switch (c[0]) {
+            case GDBATCH_PIXEL:
+                gdImageSetPixel(image, c[1], c[2], c[5]);
+                break;
+            case GDBATCH_LINE:
+                gdImageLine(image, c[1], c[2], c[3], c[4], c[5]);
+                break;
+            case GDBATCH_RECTANGLE:
+                gdImageRectangle(image, c[1], c[2], c[3], c[4], c[5]);
+                break;
+            case GDBATCH_FILLED_RECTANGLE:
+                gdImageFilledRectangle(image, c[1], c[2], c[3], c[4], c[5]);
+                break;
+            default:
+                return i;
+        }
+    }
+    return count;
+}
+
+/* end of gdbatch.c */
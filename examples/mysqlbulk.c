@@ -0,0 +1,185 @@
+/* mysqlbulk.c */
+/* Fetches the rows of a MySQL result set in bulk, into one buffer per */
+/* column, so that a Perl 6 program makes a few NativeCall crossings */
+/* per batch of rows instead of several per field.  See mysqlbulk.p6. */
+
+/* Each column of a batch is stored in three arrays: */
+/*   data    the bytes of all its fields, one after the other */
+/*   offsets rowcount + 1 offsets into data, field i being the bytes */
+/*           from data[offsets[i]] up to data[offsets[i+1]] */
+/*   nulls   rowcount bytes, 1 where the field is NULL (and empty) */
+/* The bytes are copied as they come from the server, nothing is */
+/* decoded or converted. */
+
+/* To build on Linux (mysql_config comes with the client library): */
+/*   cc -fPIC -shared -o mysqlbulk.so mysqlbulk.c `mysql_config --cflags --libs` */
+
+#include <stdlib.h>  /* malloc realloc calloc free */
+#include <string.h>  /* memcpy */
+#include <mysql.h>   /* mysql_fetch_row mysql_fetch_lengths mysql_num_fields mysql_errno */
+
+/* Starting size of each column's data buffer, which doubles as needed */
+#define MYSQLBULK_INITIAL_BYTES 4096
+
+struct mysqlbulk_column {
+    char          * data;
+    unsigned long   datasize, datacapacity;
+    long          * offsets;
+    char          * nulls;
+};
+
+typedef struct {
+    long                      rowcount;
+    int                       columncount;
+    struct mysqlbulk_column * columns;
+} mysqlbulk_batch;
+
+void mysqlbulk_free(mysqlbulk_batch * batch);
+
+
+/* mysqlbulk_fetch */
+/* Fetches up to maxrows rows from result (from mysql_store_result or */
+/* mysql_use_result on the connection mysql) in one call.  Returns NULL */
+/* when there are no more rows, if memory runs out, or if fetching a */
+/* row failed, when mysql_errno(mysql) is not 0.  A batch with rows */
+/* before the failure is dropped. */
+mysqlbulk_batch *
+mysqlbulk_fetch(MYSQL * mysql, MYSQL_RES * result, long maxrows)
+{
+    mysqlbulk_batch * batch;
+    struct mysqlbulk_column * column;
+    MYSQL_ROW row = NULL;
+    unsigned long * lengths, capacity;
+    char * data;
+    int c;
+    if (maxrows < 1)
+        return NULL;
+    batch = (mysqlbulk_batch *) calloc(1, sizeof(mysqlbulk_batch));
+    if (batch == NULL)
+        return NULL;
+    batch->columncount = (int) mysql_num_fields(result);
+    /* calloc(0, ...) may give NULL, so a result without columns has */
+    /* no column array at all */
+    if (batch->columncount > 0) {
+        batch->columns = (struct mysqlbulk_column *) calloc(batch->columncount, sizeof(struct mysqlbulk_column));
+        if (batch->columns == NULL) {
+            free(batch);
+            return NULL;
+        }
+    }
+    for (c=0; c<batch->columncount; ++c) {
+        column = &batch->columns[c];
+        column->datacapacity = MYSQLBULK_INITIAL_BYTES;
+        column->data    = (char *) malloc(column->datacapacity);
+        column->offsets = (long *) malloc((maxrows + 1) * sizeof(long));
+        column->nulls   = (char *) malloc(maxrows);
+        if (column->data == NULL || column->offsets == NULL || column->nulls == NULL) {
+            mysqlbulk_free(batch);
+            return NULL;
+        }
+        column->offsets[0] = 0;
+    }
+    while (batch->rowcount < maxrows && (row = mysql_fetch_row(result)) != NULL) {
+        lengths = mysql_fetch_lengths(result);
+        for (c=0; c<batch->columncount; ++c) {
+            column = &batch->columns[c];
+            if (column->datasize + lengths[c] > column->datacapacity) {
+                for (capacity=column->datacapacity; capacity<column->datasize+lengths[c]; capacity*=2)
+                    ;
+                data = (char *) realloc(column->data, capacity);
+                if (data == NULL) {
+                    mysqlbulk_free(batch);
+                    return NULL;
+                }
+                column->data = data;
+                column->datacapacity = capacity;
+            }
+            column->nulls[batch->rowcount] = row[c] == NULL;
+            if (row[c] != NULL)
+                memcpy(column->data + column->datasize, row[c], lengths[c]);
+            column->datasize += row[c] == NULL ? 0 : lengths[c];
+            column->offsets[batch->rowcount + 1] = (long) column->datasize;
+        }
+        ++batch->rowcount;
+    }
+    /* mysql_fetch_row gives NULL both at the end and on an error */
+    if (row == NULL && mysql_errno(mysql) != 0) {
+        mysqlbulk_free(batch);
+        return NULL;
+    }
+    if (batch->rowcount == 0) {
+        mysqlbulk_free(batch);
+        return NULL;
+    }
+    return batch;
+}
+
+
+/* mysqlbulk_rowcount */
+long
+mysqlbulk_rowcount(mysqlbulk_batch * batch)
+{
+    return batch->rowcount;
+}
+
+
+/* mysqlbulk_columncount */
+int
+mysqlbulk_columncount(mysqlbulk_batch * batch)
+{
+    return batch->columncount;
+}
+
+
+/* mysqlbulk_databytes */
+/* How many bytes mysqlbulk_copydata will copy for a column */
+long
+mysqlbulk_databytes(mysqlbulk_batch * batch, int column)
+{
+    return (long) batch->columns[column].datasize;
+}
+
+
+/* mysqlbulk_copydata */
+/* Copies the bytes of a column into buffer, which must have room for */
+/* mysqlbulk_databytes of them.  A Perl 6 Buf can be passed directly. */
+void
+mysqlbulk_copydata(mysqlbulk_batch * batch, int column, char * buffer)
+{
+    memcpy(buffer, batch->columns[column].data, batch->columns[column].datasize);
+}
+
+
+/* mysqlbulk_offsets */
+/* The rowcount + 1 offsets of a column, valid until mysqlbulk_free */
+long *
+mysqlbulk_offsets(mysqlbulk_batch * batch, int column)
+{
+    return batch->columns[column].offsets;
+}
+
+
+/* mysqlbulk_nulls */
+/* The rowcount NULL flags of a column, valid until mysqlbulk_free */
+char *
+mysqlbulk_nulls(mysqlbulk_batch * batch, int column)
+{
+    return batch->columns[column].nulls;
+}
+
+
+/* mysqlbulk_free */
+void
+mysqlbulk_free(mysqlbulk_batch * batch)
+{
+    int c;
+    for (c=0; c<batch->columncount; ++c) {
+        free(batch->columns[c].data);
+        free(batch->columns[c].offsets);
+        free(batch->columns[c].nulls);
+    }
+    free(batch->columns);
+    free(batch);
+}
+
+/* end of mysqlbulk.c */
@@ -0,0 +1,106 @@
+/* shmring-test.c */
+/* Tests of shmring.c, in one process and between a parent and a */
+/* forked child.  The output is TAP. */
+
+/* To build and run on Linux: */
+/*   cc -O2 -o shmring-test shmring-test.c shmring.c */
+/*   ./shmring-test */
+/* or with prove: prove -e '' ./shmring-test */
+
+#include <stdio.h>      /* printf */
+#include <stdlib.h>     /* exit */
+#include <unistd.h>     /* fork */
+#include <sys/wait.h>   /* waitpid */
+
+typedef struct ShmRing ShmRing;
+
+ShmRing * shmring_create     (long capacity, long record_size);
+void      shmring_destroy    (ShmRing * ring);
+long      shmring_push       (ShmRing * ring, const void * records, long count);
+long      shmring_pop        (ShmRing * ring, void * records, long max);
+long      shmring_push_wait  (ShmRing * ring, const void * records, long count, long timeout_ms);
+long      shmring_pop_wait   (ShmRing * ring, void * records, long max, long timeout_ms);
+void      shmring_close      (ShmRing * ring);
+long      shmring_size       (ShmRing * ring);
+long      shmring_capacity   (ShmRing * ring);
+long      shmring_record_size(ShmRing * ring);
+
+#define TRANSFERS 1000000L
+
+static int test_number = 0;
+
+
+/* test_ok */
+static void
+test_ok(int ok, const char * description)
+{
+    printf("%sok %d - %s\n", ok ? "" : "not ", ++test_number, description);
+    fflush(stdout);
+}
+
+
+/* main */
+int
+main(void)
+{
+    ShmRing * ring;
+    long records[8], out[8], i, n, expected;
+    int ok, status;
+    pid_t child;
+
+    printf("1..15\n");
+    test_ok(shmring_create(0, 8) == NULL, "no ring of no records");
+    ring = shmring_create(3, sizeof(long));
+    test_ok(ring != NULL, "creates a ring");
+    test_ok(shmring_capacity(ring) == 4, "capacity rounded up to a power of 2");
+    test_ok(shmring_record_size(ring) == sizeof(long), "record size");
+
+    for (i=0; i<8; ++i)
+        records[i] = i;
+    test_ok(shmring_push(ring, records, 3) == 3 && shmring_size(ring) == 3, "pushes");
+    test_ok(shmring_push(ring, records + 3, 5) == 1, "pushes only what fits");
+    test_ok(shmring_pop(ring, out, 2) == 2 && out[0] == 0 && out[1] == 1, "pops in order");
+    test_ok(shmring_push(ring, records + 4, 2) == 2, "pushes across the end");
+    n = shmring_pop(ring, out, 8);
+    for (ok=1, i=0; i<n; ++i)
+        ok = ok && out[i] == i + 2;
+    test_ok(n == 4 && ok, "pops across the end");
+    test_ok(shmring_pop_wait(ring, out, 1, 10) == 0, "pop times out when empty");
+    shmring_push(ring, records, 4);
+    test_ok(shmring_push_wait(ring, records, 1, 10) == 0, "push times out when full");
+    shmring_close(ring);
+    test_ok(shmring_pop_wait(ring, out, 8, -1) == 4, "pops what was pushed before the close");
+    test_ok(shmring_pop_wait(ring, out, 8, -1) == -1, "then finds it closed");
+    shmring_destroy(ring);
+
+    /* a child pushes numbers in batches of varied size, the parent */
+    /* checks that they all come in order */
+    ring = shmring_create(64, sizeof(long));
+    child = fork();
+    if (child == 0) {
+        long next = 0, size, j;
+        while (next < TRANSFERS) {
+            size = 1 + next % 7;
+            for (j=0; j<size; ++j)
+                records[j] = next + j;
+            if (next + size > TRANSFERS)
+                size = TRANSFERS - next;
+            /* after a partial push, the rest are made again */
+            next += shmring_push_wait(ring, records, size, -1);
+        }
+        shmring_close(ring);
+        exit(0);
+    }
+    expected = 0;
+    ok = 1;
+    while ((n = shmring_pop_wait(ring, out, 8, -1)) > 0)
+        for (i=0; i<n; ++i)
+            ok = ok && out[i] == expected++;
+    test_ok(ok && expected == TRANSFERS, "a million records from a child, in order");
+    waitpid(child, &status, 0);
+    test_ok(n == -1, "and the close");
+    shmring_destroy(ring);
+    return 0;
+}
+
+/* end of shmring-test.c */
@@ -0,0 +1,318 @@
+/* shmring.c */
+/* A ring of fixed size records in memory shared between processes, */
+/* for one process that pushes records and one that pops them, such as */
+/* a parent and a child made by fork().  See ShmRing.pm. */
+
+/* shmring_create(capacity, record_size) */
+/*   maps a ring of capacity records, rounded up to a power of 2, of */
+/*   record_size bytes each, shared with the children forked after it, */
+/*   or returns NULL */
+/* shmring_destroy(ring)                  unmaps the ring */
+/* shmring_push(ring, records, count)     copies up to count records */
+/*                                        in, returns how many */
+/* shmring_pop(ring, records, max)        copies up to max records out, */
+/*                                        returns how many */
+/* shmring_push_wait(ring, records, count, timeout_ms) */
+/* shmring_pop_wait(ring, records, max, timeout_ms) */
+/*   the same, but wait for at least one record to fit or to arrive, */
+/*   for up to timeout_ms milliseconds, or forever if it is negative; */
+/*   they return 0 when the time is up, and pop returns -1 when the */
+/*   ring is empty and closed */
+/* shmring_close(ring)                    tells the popping process */
+/*                                        that no more will come */
+/* shmring_size(ring)                     records in the ring now */
+/* shmring_capacity(ring) */
+/* shmring_record_size(ring) */
+
+/* Neither side takes a lock.  The pushing process alone moves the */
+/* head and the popping process alone moves the tail, and each reads */
+/* the other's index with acquire ordering before touching records. */
+/* A side that has to wait spins a little, then sleeps on a futex on */
+/* Linux, and is only woken by a system call from the other side when */
+/* it said that it sleeps.  Elsewhere it polls every 100 microseconds. */
+
+/* To build on Linux: */
+/*   cc -O2 -fPIC -shared -o shmring.so shmring.c */
+
+#define _GNU_SOURCE
+#include <stdatomic.h>  /* atomic_* */
+#include <stdint.h>     /* uint32_t */
+#include <stddef.h>     /* NULL, size_t */
+#include <string.h>     /* memcpy */
+#include <time.h>       /* clock_gettime, nanosleep */
+#include <sys/mman.h>   /* mmap, munmap */
+#ifdef __linux__
+#include <linux/futex.h>  /* FUTEX_WAIT, FUTEX_WAKE */
+#include <sys/syscall.h>  /* SYS_futex */
+#include <unistd.h>       /* syscall */
+#endif
+
+#define SHMRING_CACHE_LINE   64
+#define SHMRING_SPINS      1000
+#define SHMRING_MAX_CAPACITY (1UL << 30)
+
+/* The indices count records pushed and popped modulo 2^32, so that */
+/* head - tail is the number in the ring; a capacity that is a power of */
+/* 2 keeps the position of a record the same across the wrap. */
+typedef struct {
+    _Alignas(SHMRING_CACHE_LINE) _Atomic uint32_t head;
+    _Atomic uint32_t head_signal;   /* futex the popping side sleeps on */
+    _Atomic uint32_t pop_waiting;
+    _Atomic uint32_t closed;
+    _Alignas(SHMRING_CACHE_LINE) _Atomic uint32_t tail;
+    _Atomic uint32_t tail_signal;   /* futex the pushing side sleeps on */
+    _Atomic uint32_t push_waiting;
+    _Alignas(SHMRING_CACHE_LINE) uint32_t capacity;
+    uint32_t record_size;
+    size_t   mapped;
+} ShmRing;
+
+#define SHMRING_RECORDS(ring) ((char *) (ring) + sizeof(ShmRing))
+
+
+/* shmring_create */
+ShmRing *
+shmring_create(long capacity, long record_size)
+{
+    ShmRing * ring;
+    unsigned long rounded = 1;
+    size_t mapped;
+    void * memory;
+    if (capacity < 1 || record_size < 1 || (unsigned long) capacity > SHMRING_MAX_CAPACITY)
+        return NULL;
+    while (rounded < (unsigned long) capacity)
+        rounded <<= 1;
+    mapped = sizeof(ShmRing) + rounded * (size_t) record_size;
+    memory = mmap(NULL, mapped, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return NULL;
+    ring = (ShmRing *) memory;  /* mmap gives zeroed memory */
+    ring->capacity    = (uint32_t) rounded;
+    ring->record_size = (uint32_t) record_size;
+    ring->mapped      = mapped;
+    return ring;
+}
+
+
+/* shmring_destroy */
+void
+shmring_destroy(ShmRing * ring)
+{
+    if (ring != NULL)
+        munmap(ring, ring->mapped);
+}
+
+
+/* shmring_wake */
+static void
+shmring_wake(_Atomic uint32_t * signal)
+{
+    atomic_fetch_add(signal, 1);
+#ifdef __linux__
+    syscall(SYS_futex, (uint32_t *) signal, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+
+/* shmring_sleep */
+/* Sleeps until *signal is no longer seen, at most until deadline (none */
+/* if NULL), unless *index is no longer index_seen or *closed is set */
+/* by then; the other side wakes it if it finds *waiting set */
+static void
+shmring_sleep(_Atomic uint32_t * signal, _Atomic uint32_t * waiting,
+              _Atomic uint32_t * index, uint32_t index_seen,
+              _Atomic uint32_t * closed, const struct timespec * deadline)
+{
+    uint32_t seen = atomic_load(signal);
+    struct timespec now, left, * timeout = NULL;
+    if (deadline != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        left.tv_sec  = deadline->tv_sec - now.tv_sec;
+        left.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+        if (left.tv_nsec < 0) {
+            left.tv_nsec += 1000000000L;
+            --left.tv_sec;
+        }
+        if (left.tv_sec < 0)
+            return;
+        timeout = &left;
+    }
+    atomic_store(waiting, 1);
+    if (atomic_load(index) == index_seen && (closed == NULL || !atomic_load(closed))) {
+#ifdef __linux__
+        syscall(SYS_futex, (uint32_t *) signal, FUTEX_WAIT, seen, timeout, NULL, 0);
+#else
+        struct timespec poll = { 0, 100000L };
+        (void) seen;
+        (void) timeout;
+        nanosleep(&poll, NULL);
+#endif
+    }
+    atomic_store(waiting, 0);
+}
+
+
+/* shmring_deadline */
+static const struct timespec *
+shmring_deadline(long timeout_ms, struct timespec * deadline)
+{
+    if (timeout_ms < 0)
+        return NULL;
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec  += timeout_ms / 1000;
+    deadline->tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_nsec -= 1000000000L;
+        ++deadline->tv_sec;
+    }
+    return deadline;
+}
+
+
+/* shmring_passed */
+static int
+shmring_passed(const struct timespec * deadline)
+{
+    struct timespec now;
+    if (deadline == NULL)
+        return 0;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline->tv_sec
+        || (now.tv_sec == deadline->tv_sec && now.tv_nsec >= deadline->tv_nsec);
+}
+
+
+/* shmring_copy */
+/* Copies count records between the ring, from position index on, and */
+/* records, in two pieces if they go past the end of the ring */
+static void
+shmring_copy(ShmRing * ring, uint32_t index, char * records, uint32_t count, int in)
+{
+    uint32_t position = index & (ring->capacity - 1);
+    uint32_t first = ring->capacity - position < count ? ring->capacity - position : count;
+    size_t size = ring->record_size;
+    char * slots = SHMRING_RECORDS(ring);
+    if (in) {
+        memcpy(slots + position * size, records, first * size);
+        memcpy(slots, records + first * size, (count - first) * size);
+    }
+    else {
+        memcpy(records, slots + position * size, first * size);
+        memcpy(records + first * size, slots, (count - first) * size);
+    }
+}
+
+
+/* shmring_push */
+long
+shmring_push(ShmRing * ring, const void * records, long count)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t room = ring->capacity - (head - tail);
+    uint32_t n = count < (long) room ? (uint32_t) (count < 0 ? 0 : count) : room;
+    if (n == 0)
+        return 0;
+    shmring_copy(ring, head, (char *) records, n, 1);
+    atomic_store(&ring->head, head + n);
+    if (atomic_load(&ring->pop_waiting))
+        shmring_wake(&ring->head_signal);
+    return n;
+}
+
+
+/* shmring_pop */
+long
+shmring_pop(ShmRing * ring, void * records, long max)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t ready = head - tail;
+    uint32_t n = max < (long) ready ? (uint32_t) (max < 0 ? 0 : max) : ready;
+    if (n == 0)
+        return 0;
+    shmring_copy(ring, tail, (char *) records, n, 0);
+    atomic_store(&ring->tail, tail + n);
+    if (atomic_load(&ring->push_waiting))
+        shmring_wake(&ring->tail_signal);
+    return n;
+}
+
+
+/* shmring_push_wait */
+long
+shmring_push_wait(ShmRing * ring, const void * records, long count, long timeout_ms)
+{
+    struct timespec until;
+    const struct timespec * deadline = shmring_deadline(timeout_ms, &until);
+    long pushed, spin;
+    for (;;) {
+        for (spin=0; spin<SHMRING_SPINS; ++spin)
+            if ((pushed = shmring_push(ring, records, count)) != 0 || count < 1)
+                return pushed;
+        if (shmring_passed(deadline))
+            return 0;
+        shmring_sleep(&ring->tail_signal, &ring->push_waiting, &ring->tail,
+            atomic_load(&ring->head) - ring->capacity, NULL, deadline);
+    }
+}
+
+
+/* shmring_pop_wait */
+long
+shmring_pop_wait(ShmRing * ring, void * records, long max, long timeout_ms)
+{
+    struct timespec until;
+    const struct timespec * deadline = shmring_deadline(timeout_ms, &until);
+    long popped, spin;
+    for (;;) {
+        for (spin=0; spin<SHMRING_SPINS; ++spin) {
+            if ((popped = shmring_pop(ring, records, max)) != 0 || max < 1)
+                return popped;
+            if (atomic_load(&ring->closed)) {
+                /* records pushed before the close are still popped */
+                popped = shmring_pop(ring, records, max);
+                return popped ? popped : -1;
+            }
+        }
+        if (shmring_passed(deadline))
+            return 0;
+        shmring_sleep(&ring->head_signal, &ring->pop_waiting, &ring->head,
+            atomic_load(&ring->tail), &ring->closed, deadline);
+    }
+}
+
+
+/* shmring_close */
+void
+shmring_close(ShmRing * ring)
+{
+    atomic_store(&ring->closed, 1);
+    shmring_wake(&ring->head_signal);
+}
+
+
+/* shmring_size */
+long
+shmring_size(ShmRing * ring)
+{
+    return atomic_load(&ring->head) - atomic_load(&ring->tail);
+}
+
+
+/* shmring_capacity */
+long
+shmring_capacity(ShmRing * ring)
+{
+    return ring->capacity;
+}
+
+
+/* shmring_record_size */
+long
+shmring_record_size(ShmRing * ring)
+{
+    return ring->record_size;
+}
+
+/* end of shmring.c */
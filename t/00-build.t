@@ -0,0 +1,16 @@
+use lib '.';
+use t::CompileTestLib;
+use Test;
+
+# Builds the libraries of all the tests at once, so that the tests
+# after this one find them already built (see compile_test_lib).
+
+my @names = dir('t', test => /\.c$/).map({ .basename.subst(/\.c$/, '') }).sort;
+
+plan +@names;
+
+compile_test_libs(@names);
+
+ok test_lib_filename($_).IO.e, "built $_" for @names;
+
+# vim:ft=perl6
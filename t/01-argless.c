@@ -17,3 +17,7 @@ DLLEXPORT void long_and_complicated_name()
     printf("ok 3 - called long_and_complicated_name\n");
     fflush(stdout);
 }
+
+DLLEXPORT void ArglessQuietly()
+{
+}
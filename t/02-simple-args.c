@@ -83,3 +83,12 @@ DLLEXPORT void wrapped(int n) {
     printf("ok 11 - wrapped sub\n");
     fflush(stdout);
 }
+
+DLLEXPORT void TakeTwoIntsQuietly(int x, int y) {
+}
+
+DLLEXPORT void TakeTwoDoublesQuietly(double x, double y) {
+}
+
+DLLEXPORT void TakeAStringQuietly(char *str) {
+}
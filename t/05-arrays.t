@@ -3,7 +3,7 @@ use t::CompileTestLib;
 use NativeCall;
 use Test;
 
-plan 20;
+plan 35;
 
 compile_test_lib('05-arrays');
 
@@ -13,6 +13,9 @@ compile_test_lib('05-arrays');
     is_approx @rarr[0], 23.45e0, 'returning double array (1)';
     is_approx @rarr[1], -99.87e0, 'returning double array (2)';
     is_approx @rarr[2], 0.25e0, 'returning double array (3)';
+    is @rarr.elems, 0, 'an array from C has 0 elements';
+    dies_ok { @rarr.shrink(2) }, 'so it cannot be shrunk';
+    dies_ok { @rarr.reserve(10) }, 'nor grown';
 
     sub TakeADoubleArrayAndAddElements(CArray[num]) returns num is native("./05-arrays") { * }
     my @parr := CArray[num].new();
@@ -115,4 +118,34 @@ compile_test_lib('05-arrays');
     is_approx SumAFloatArray(@parr), 57.9e0, 'sum of float array';
 }
 
+{
+    my $ints = CArray[int32].allocate(1000);
+    is $ints.elems, 1000, 'allocate makes an array of that many elements';
+    is $ints[999], 0, 'allocated int elements are 0';
+    $ints[$_] = $_ for ^1000;
+    is $ints.elems, 1000, 'filling an allocated array does not grow it';
+
+    $ints.reserve(10);
+    is $ints.elems, 1000, 'reserve does not shrink';
+    $ints.reserve(2000);
+    is $ints.elems, 2000, 'reserve grows';
+    is $ints[999], 999, 'reserve keeps the elements';
+
+    my $start = $ints.shrink(3);
+    is $start.elems, 3, 'shrink makes an array of that many elements';
+    is [$start[^3]], [0, 1, 2], 'shrink copies the elements';
+    dies_ok { $start.shrink(4) }, 'shrink dies rather than read past the end';
+
+    my $strs = CArray[Str].allocate(2);
+    $strs[0] = 'La Trappe';
+    ok !$strs[1].defined, 'allocated Str elements are the type object';
+    is $strs.shrink(1)[0], 'La Trappe', 'shrink copies other elements';
+
+    sub TakeADoubleArrayAndAddElements(CArray[num]) returns num is native("./05-arrays") { * }
+    my $nums = CArray[num].allocate(2);
+    $nums[0] = 9.5e0;
+    $nums[1] = 32.5e0;
+    is_approx TakeADoubleArrayAndAddElements($nums), 42e0, 'passing an allocated double array';
+}
+
 # vim:ft=perl6
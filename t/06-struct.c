@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 
 #ifdef WIN32
 #define DLLEXPORT __declspec(dllexport)
@@ -110,3 +111,16 @@ DLLEXPORT void TakeAStringStruct(StringStruct *obj) {
 DLLEXPORT long _deref(long *ptr) {
     return *ptr;
 }
+
+/* The offsets of the fields of MyStruct, in order, to check those that
+ * NativeCall works out against */
+DLLEXPORT long MyStructOffset(int field)
+{
+    switch (field) {
+        case 0:  return (long) offsetof(MyStruct, intval);
+        case 1:  return (long) offsetof(MyStruct, numval);
+        case 2:  return (long) offsetof(MyStruct, byteval);
+        case 3:  return (long) offsetof(MyStruct, floatval);
+        default: return (long) offsetof(MyStruct, arr);
+    }
+}
@@ -3,7 +3,7 @@ use t::CompileTestLib;
 use NativeCall;
 use Test;
 
-plan 19;
+plan 23;
 
 compile_test_lib('06-struct');
 
@@ -149,4 +149,10 @@ $strstr2.init;
 #$strstr2.second := "ipsum";
 TakeAStringStruct($strstr2);
 
+sub MyStructOffset(int32) returns long is native('./06-struct') { * }
+is field-offset(MyStruct, 'long'), MyStructOffset(0), 'offset of the first field';
+is field-offset(MyStruct, 'byte'), MyStructOffset(2), 'offset of a field after a double';
+is field-offset(MyStruct, '$!float'), MyStructOffset(3), 'offset of a float aligned after a byte';
+is field-offset(MyStruct, 'arr'), MyStructOffset(4), 'offset of a pointer aligned after a float';
+
 # vim:ft=perl6
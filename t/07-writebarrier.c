@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stddef.h>
 
 #ifdef WIN32
 #define DLLEXPORT __declspec(dllexport)
@@ -10,7 +11,33 @@ typedef struct {
     long *ptr;
 } Structy;
 
+typedef struct {
+    int   tag;
+    long *first;
+    long *second;
+} Pair;
+
+/* Fields of all sizes, so that padding comes in between */
+typedef struct {
+    char  flag;
+    long  count;
+    short small;
+    long *ptr;
+} Mixed;
+
+typedef struct {
+    char *name;
+    long *ptr;
+} Named;
+
+static char from_c[] = "from C";
+
 static Structy *saved = NULL;
+static Pair *saved_pair = NULL;
+static long **saved_array = NULL;
+static Mixed *saved_mixed = NULL;
+static Named *saved_named = NULL;
+static char **saved_strings = NULL;
 
 DLLEXPORT long _deref(long *ptr) {
     return *ptr;
@@ -49,3 +76,52 @@ DLLEXPORT void atadistance(void) {
     saved->ptr = (long *) malloc(sizeof(long));
     *(saved->ptr) = 42;
 }
+
+DLLEXPORT void save_pair(Pair *p) {
+    saved_pair = p;
+}
+
+DLLEXPORT void pair_atadistance(void) {
+    saved_pair->second = (long *) malloc(sizeof(long));
+    *(saved_pair->second) = 7;
+}
+
+DLLEXPORT void save_array(long **arr) {
+    saved_array = arr;
+}
+
+DLLEXPORT void array_atadistance(void) {
+    saved_array[1] = (long *) malloc(sizeof(long));
+    *saved_array[1] = 5;
+}
+
+DLLEXPORT void save_mixed(Mixed *m) {
+    saved_mixed = m;
+}
+
+DLLEXPORT void mixed_atadistance(void) {
+    saved_mixed->ptr = (long *) malloc(sizeof(long));
+    *(saved_mixed->ptr) = 11;
+}
+
+DLLEXPORT long MixedPtrOffset(void) {
+    return (long) offsetof(Mixed, ptr);
+}
+
+DLLEXPORT void save_named(Named *n) {
+    saved_named = n;
+    n->name = from_c;
+}
+
+DLLEXPORT int named_unchanged(void) {
+    return saved_named->name == from_c;
+}
+
+DLLEXPORT void save_strings(char **strings) {
+    saved_strings = strings;
+    strings[0] = from_c;
+}
+
+DLLEXPORT int strings_unchanged(void) {
+    return saved_strings[0] == from_c;
+}
@@ -3,7 +3,7 @@ use t::CompileTestLib;
 use NativeCall;
 use Test;
 
-plan 7;
+plan 18;
 
 compile_test_lib('07-writebarrier');
 
@@ -20,12 +20,51 @@ class Structy is repr('CStruct') {
     }
 }
 
+class Pair is repr('CStruct') {
+    has int32  $.tag;
+    has IntPtr $.first;
+    has IntPtr $.second;
+
+    method set(\first, \second) {
+        $!tag = 1;
+        $!first := first;
+        $!second := second;
+    }
+}
+
+class Mixed is repr('CStruct') {
+    has int8   $.flag;
+    has long   $.count;
+    has int16  $.small;
+    has IntPtr $.ptr;
+
+    method set(\ptr) {
+        $!ptr := ptr;
+    }
+}
+
+class Named is repr('CStruct') {
+    has Str    $.name;
+    has IntPtr $.ptr;
+}
+
 sub make_ptr() returns IntPtr  is native('./07-writebarrier') { * }
 sub array_twiddle(CArray[IntPtr] $a) is native('./07-writebarrier') { * }
 sub struct_twiddle(Structy $s) is native('./07-writebarrier') { * }
 sub dummy(CArray[OpaquePointer] $a) is native('./07-writebarrier') { * }
 sub save_ref(Structy $s) is native('./07-writebarrier') { * }
 sub atadistance() is native('./07-writebarrier') { * }
+sub save_pair(Pair $p) is native('./07-writebarrier') { * }
+sub pair_atadistance() is native('./07-writebarrier') { * }
+sub save_array(CArray[IntPtr] $a) is native('./07-writebarrier') { * }
+sub array_atadistance() is native('./07-writebarrier') { * }
+sub save_mixed(Mixed $m) is native('./07-writebarrier') { * }
+sub mixed_atadistance() is native('./07-writebarrier') { * }
+sub MixedPtrOffset() returns long is native('./07-writebarrier') { * }
+sub save_named(Named $n) is native('./07-writebarrier') { * }
+sub named_unchanged() returns int32 is native('./07-writebarrier') { * }
+sub save_strings(CArray[Str] $a) is native('./07-writebarrier') { * }
+sub strings_unchanged() returns int32 is native('./07-writebarrier') { * }
 
 my Structy $s .= new;
 $s.set(make_ptr);
@@ -51,4 +90,43 @@ atadistance();
 refresh($s);
 is($s.ptr.deref, 42, 'struct value after refresh');
 
+my Pair $p .= new;
+$p.set(make_ptr, make_ptr);
+my $first = $p.first;
+save_pair($p);
+pair_atadistance();
+refresh($p, 'second');
+is $p.second.deref, 7, 'struct field after refresh of that field';
+ok $p.first === $first, 'unchanged field keeps its wrapper';
+is $p.tag, 1, 'native field left alone';
+refresh($p, 'first', '$!second');
+ok $p.first === $first, 'refresh of an unchanged field keeps its wrapper';
+
+my $kept = @arr[0];
+save_array(@arr);
+array_atadistance();
+refresh(@arr, 1);
+is @arr[1].deref, 5, 'array element after refresh of that element';
+ok @arr[0] === $kept, 'other elements keep their wrappers';
+refresh(@arr, 0..2);
+is @arr[2].deref, 3, 'refresh of a range of elements';
+
+my Mixed $m .= new;
+$m.set(make_ptr);
+save_mixed($m);
+mixed_atadistance();
+is field-offset(Mixed, 'ptr'), MixedPtrOffset(), 'field after padding is where C has it';
+refresh($m, 'ptr');
+is $m.ptr.deref, 11, 'refresh of a field after padding';
+
+my Named $n .= new;
+save_named($n);
+refresh($n, 'name', 'ptr');
+ok named_unchanged(), 'refresh of a Str field leaves the C string in place';
+my @strings := CArray[Str].new;
+@strings[0] = 'from Perl';
+save_strings(@strings);
+refresh(@strings, 0);
+ok strings_unchanged(), 'refresh of a Str element leaves the C string in place';
+
 # vim:ft=perl6
@@ -0,0 +1,189 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT extern
+#endif
+
+/* A stand-in for the parts of libpq that examples/PQStream.pm uses.
+ * A query is answered with as many rows as the last number in it, each
+ * row being n, n squared, and "row n" (NULL for every seventh row).  A
+ * query containing "error" fails.  The Mock functions count what was
+ * produced, so the tests can check that rows are only made as they are
+ * read and that results do not pile up. */
+
+#define PGRES_TUPLES_OK    2
+#define PGRES_FATAL_ERROR  7
+#define PGRES_SINGLE_TUPLE 9
+#define PGRES_TUPLES_CHUNK 12
+
+typedef struct {
+    int  status;
+    long first;
+    int  count;
+} PGresult;
+
+static int  connection;
+static int  busy;          /* a query was sent and its NULL not yet returned */
+static int  failing;
+static int  finished;      /* the last result was returned */
+static int  chunk;         /* 0 for all rows in one result */
+static int  refuse_modes;  /* the set mode functions fail, as on an old libpq */
+static long nextrow, rowcount;
+static char errormessage[100] = "";
+static char value[32];
+
+static long rows_made, results_made, results_live, results_live_max;
+
+DLLEXPORT void *PQconnectdb(const char *conninfo) {
+    return &connection;
+}
+
+DLLEXPORT int PQstatus(void *conn) {
+    return 0;  /* CONNECTION_OK */
+}
+
+DLLEXPORT void PQfinish(void *conn) {
+}
+
+DLLEXPORT char *PQerrorMessage(void *conn) {
+    return errormessage;
+}
+
+DLLEXPORT int PQsendQuery(void *conn, const char *query) {
+    const char *p;
+    if (busy) {
+        strcpy(errormessage, "another command is already in progress\n");
+        return 0;
+    }
+    busy     = 1;
+    failing  = strstr(query, "error") != NULL;
+    finished = 0;
+    chunk    = 0;
+    nextrow  = 0;
+    rowcount = 0;
+    for (p = query + strlen(query); p > query && (p[-1] < '0' || p[-1] > '9'); --p)
+        ;
+    while (p > query && p[-1] >= '0' && p[-1] <= '9')
+        --p;
+    rowcount = atol(p);
+    return 1;
+}
+
+DLLEXPORT int PQsetSingleRowMode(void *conn) {
+    if (!busy || nextrow > 0 || refuse_modes)
+        return 0;
+    chunk = 1;
+    return 1;
+}
+
+DLLEXPORT int PQsetChunkedRowsMode(void *conn, int chunkSize) {
+    if (!busy || nextrow > 0 || chunkSize < 1 || refuse_modes)
+        return 0;
+    chunk = chunkSize;
+    return 1;
+}
+
+DLLEXPORT PGresult *PQgetResult(void *conn) {
+    PGresult *res;
+    if (!busy)
+        return NULL;
+    if (finished) {
+        busy = 0;
+        return NULL;
+    }
+    res = (PGresult *) malloc(sizeof(PGresult));
+    res->first = nextrow;
+    res->count = 0;
+    if (failing) {
+        strcpy(errormessage, "ERROR:  mock error\n");
+        res->status = PGRES_FATAL_ERROR;
+        finished = 1;
+    }
+    else if (chunk == 0 || nextrow == rowcount) {
+        /* everything that is left, then the end of the query */
+        res->status = PGRES_TUPLES_OK;
+        res->count  = (int) (rowcount - nextrow);
+        finished = 1;
+    }
+    else {
+        res->status = chunk == 1 ? PGRES_SINGLE_TUPLE : PGRES_TUPLES_CHUNK;
+        res->count  = (int) (rowcount - nextrow < chunk ? rowcount - nextrow : chunk);
+    }
+    nextrow   += res->count;
+    rows_made += res->count;
+    ++results_made;
+    if (++results_live > results_live_max)
+        results_live_max = results_live;
+    return res;
+}
+
+DLLEXPORT int PQresultStatus(PGresult *res) {
+    return res->status;
+}
+
+DLLEXPORT int PQntuples(PGresult *res) {
+    return res->count;
+}
+
+DLLEXPORT int PQnfields(PGresult *res) {
+    return res->status == PGRES_FATAL_ERROR ? 0 : 3;
+}
+
+DLLEXPORT char *PQfname(PGresult *res, int field) {
+    static char *names[] = { "n", "square", "label" };
+    return field >= 0 && field < 3 ? names[field] : NULL;
+}
+
+DLLEXPORT int PQgetisnull(PGresult *res, int row, int field) {
+    return field == 2 && (res->first + row + 1) % 7 == 0;
+}
+
+/* Only valid until the next call, which is enough for NativeCall, as it
+ * copies the string at once */
+DLLEXPORT char *PQgetvalue(PGresult *res, int row, int field) {
+    long n = res->first + row + 1;
+    if (PQgetisnull(res, row, field))
+        value[0] = '\0';
+    else if (field == 0)
+        sprintf(value, "%ld", n);
+    else if (field == 1)
+        sprintf(value, "%ld", n * n);
+    else
+        sprintf(value, "row %ld", n);
+    return value;
+}
+
+DLLEXPORT void PQclear(PGresult *res) {
+    if (res == NULL)
+        return;
+    --results_live;
+    free(res);
+}
+
+DLLEXPORT long MockRowsMade(void) {
+    return rows_made;
+}
+
+DLLEXPORT long MockResultsMade(void) {
+    return results_made;
+}
+
+DLLEXPORT long MockResultsLive(void) {
+    return results_live;
+}
+
+DLLEXPORT long MockResultsLiveMax(void) {
+    return results_live_max;
+}
+
+DLLEXPORT void MockRefuseModes(int refuse) {
+    refuse_modes = refuse;
+}
+
+DLLEXPORT void MockReset(void) {
+    rows_made = results_made = results_live_max = 0;
+}
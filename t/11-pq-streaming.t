@@ -0,0 +1,71 @@
+use lib '.';
+use lib 'examples';
+use t::CompileTestLib;
+# PQStream binds to whatever library this names when it is compiled
+BEGIN { %*ENV<PQSTREAM_LIBPQ> = './11-pq-streaming' }
+use PQStream;
+use NativeCall;
+use Test;
+
+plan(20);
+
+compile_test_lib('11-pq-streaming');
+
+sub PQconnectdb(Str) returns OpaquePointer is native('./11-pq-streaming') { * }
+sub MockRowsMade() returns long is native('./11-pq-streaming') { * }
+sub MockResultsMade() returns long is native('./11-pq-streaming') { * }
+sub MockResultsLive() returns long is native('./11-pq-streaming') { * }
+sub MockResultsLiveMax() returns long is native('./11-pq-streaming') { * }
+sub MockRefuseModes(int32) is native('./11-pq-streaming') { * }
+sub MockReset() is native('./11-pq-streaming') { * }
+
+my $conn = PQconnectdb('dbname=mock');
+
+# Only the rows that are read are fetched
+my @first = stream-rows($conn, 'SELECT * FROM generate_series(1, 10000)')[^3];
+is_deeply @first[0], ['1', '1', 'row 1'], 'first row';
+is @first[2][1], '9', 'third row';
+ok MockRowsMade() < 1000, 'rows are fetched as they are read';
+finish-stream($conn);
+is MockResultsLive(), 0, 'finish-stream frees the rest of the results';
+
+# Single row mode: one result of one row at a time
+MockReset();
+my ($count, $sum, $nulls) = 0, 0, 0;
+for stream-rows($conn, 'SELECT * FROM generate_series(1, 20000)') -> @row {
+    ++$count;
+    $sum += @row[0];
+    ++$nulls unless @row[2].defined;
+}
+is $count, 20000, 'single row mode gets every row';
+is $sum, 200010000, 'single row mode gets the values';
+is $nulls, 2857, 'NULL reads as Str';
+is MockResultsMade(), 20001, 'one result per row, and the last one';
+is MockResultsLiveMax(), 1, 'only one result at a time';
+is MockResultsLive(), 0, 'every result is freed';
+
+# Chunked rows mode
+MockReset();
+($count, $sum) = 0, 0;
+for stream-rows($conn, 'SELECT * FROM generate_series(1, 20000)', :chunk(1000)) -> @row {
+    ++$count;
+    $sum += @row[0];
+}
+is $count, 20000, 'chunked mode gets every row';
+is $sum, 200010000, 'chunked mode gets the values';
+is MockResultsMade(), 21, 'one result per chunk, and the last one';
+is MockResultsLiveMax(), 1, 'only one chunk at a time';
+
+# Errors
+dies_ok { stream-rows($conn, 'SELECT error').eager }, 'failed query dies';
+is MockResultsLive(), 0, 'failed query frees its result';
+is +stream-rows($conn, 'SELECT 5').list, 5, 'connection works after an error';
+
+# A libpq that cannot stream
+MockRefuseModes(1);
+dies_ok { stream-rows($conn, 'SELECT 5') }, 'dies when single row mode cannot be set';
+dies_ok { stream-rows($conn, 'SELECT 5', :chunk(100)) }, 'dies when chunked rows mode cannot be set';
+MockRefuseModes(0);
+is +stream-rows($conn, 'SELECT 5').list, 5, 'connection works after a refused mode';
+
+# vim:ft=perl6
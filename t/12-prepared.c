@@ -0,0 +1,368 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT extern
+#endif
+
+/* A stand-in for the parts of libpq and libmysqlclient that
+ * examples/PQPrepared.pm and examples/MysqlStmt.pm use, and that
+ * bench/02-prepared.pl6 times them against.  Like a server, it parses
+ * every statement sent with PQexec or mysql_query, and the values in
+ * it, but only parses a prepared statement once and then reads its
+ * parameters as they come.  It remembers the values of the last row
+ * (see the Mock functions at the end), so the tests can check them. */
+
+#define MAXPARAMS 16
+
+/* from libpq-fe.h and pg_type.h */
+#define PGRES_COMMAND_OK  1
+#define PGRES_FATAL_ERROR 7
+#define INT8OID   20
+#define INT4OID   23
+#define TEXTOID   25
+#define FLOAT8OID 701
+
+/* from mysql.h (enum_field_types) */
+#define MYSQL_TYPE_LONG        3
+#define MYSQL_TYPE_DOUBLE      5
+#define MYSQL_TYPE_LONGLONG    8
+#define MYSQL_TYPE_BLOB        252
+#define MYSQL_TYPE_VAR_STRING  253
+#define MYSQL_TYPE_STRING      254
+
+/* Laid out like MYSQL_BIND in MySQL 5.x and 8.0 and in MariaDB */
+typedef struct {
+    unsigned long *length;
+    char          *is_null;
+    void          *buffer;
+    char          *error;
+    unsigned char *row_ptr;
+    void          *store_param_func;
+    void          *fetch_result;
+    void          *skip_result;
+    unsigned long  buffer_length;
+    unsigned long  offset;
+    unsigned long  length_value;
+    unsigned int   param_number;
+    unsigned int   pack_length;
+    int            buffer_type;
+    char           error_value;
+    char           is_unsigned;
+    char           long_data_used;
+    char           is_null_value;
+    void          *extension;
+} MYSQL_BIND;
+
+typedef struct {
+    int status;
+} PGresult;
+
+typedef struct {
+    unsigned long paramcount;
+    MYSQL_BIND    params[MAXPARAMS];
+} MYSQL_STMT;
+
+typedef struct {
+    char name[64];
+    int  paramcount;
+    int  types[MAXPARAMS];
+} Prepared;
+
+static int      connection;
+static Prepared prepared;
+static char     errormessage[100] = "";
+
+/* The last row */
+static char   kinds[MAXPARAMS];  /* i n s or 0 for NULL */
+static long   ints[MAXPARAMS];
+static double nums[MAXPARAMS];
+static char   strs[MAXPARAMS][256];
+static int    columns;
+static long   rows, parses;
+
+static void set_int(int col, long value) {
+    kinds[col] = 'i';
+    ints[col]  = value;
+}
+
+static void set_num(int col, double value) {
+    kinds[col] = 'n';
+    nums[col]  = value;
+}
+
+static void set_str(int col, const char *value, size_t length) {
+    if (length > 255)
+        length = 255;
+    kinds[col] = 's';
+    memcpy(strs[col], value, length);
+    strs[col][length] = '\0';
+}
+
+/* Reads the values of an INSERT ... VALUES (...) statement: numbers,
+ * 'strings' with '' for a quote, and NULL */
+static void parse_values(const char *sql) {
+    const char *p = strstr(sql, "VALUES");
+    char *end;
+    size_t length;
+    ++parses;
+    if (p == NULL || (p = strchr(p, '(')) == NULL)
+        return;
+    for (columns = 0, ++p; *p && *p != ')' && columns < MAXPARAMS; ++columns) {
+        while (*p == ' ')
+            ++p;
+        if (*p == '\'') {
+            for (length = 0, ++p; *p && !(*p == '\'' && p[1] != '\''); ++p)
+                if (length < 255)
+                    strs[columns][length++] = *p == '\'' ? *++p : *p;
+            strs[columns][length] = '\0';
+            kinds[columns] = 's';
+            if (*p)
+                ++p;
+        }
+        else if (strncmp(p, "NULL", 4) == 0) {
+            kinds[columns] = 0;
+            p += 4;
+        }
+        else {
+            length = strcspn(p, ",)");
+            if (memchr(p, '.', length) || memchr(p, 'e', length))
+                set_num(columns, strtod(p, &end));
+            else
+                set_int(columns, strtol(p, &end, 10));
+            p = end;
+        }
+        while (*p == ' ')
+            ++p;
+        if (*p == ',')
+            ++p;
+    }
+    ++rows;
+}
+
+static int count_placeholders(const char *sql, char mark) {
+    int count = 0, quoted = 0;
+    for (; *sql; ++sql) {
+        if (*sql == '\'')
+            quoted = !quoted;
+        else if (*sql == mark && !quoted)
+            ++count;
+    }
+    return count;
+}
+
+static unsigned long long from_network_order(const unsigned char *bytes, int count) {
+    unsigned long long value = 0;
+    int i;
+    for (i=0; i<count; ++i)
+        value = value << 8 | bytes[i];
+    return value;
+}
+
+static PGresult *make_result(int status) {
+    PGresult *res = (PGresult *) malloc(sizeof(PGresult));
+    res->status = status;
+    return res;
+}
+
+/* libpq */
+
+DLLEXPORT void *PQconnectdb(const char *conninfo) {
+    return &connection;
+}
+
+DLLEXPORT void PQfinish(void *conn) {
+}
+
+DLLEXPORT char *PQerrorMessage(void *conn) {
+    return errormessage;
+}
+
+DLLEXPORT int PQresultStatus(PGresult *res) {
+    return res->status;
+}
+
+DLLEXPORT void PQclear(PGresult *res) {
+    free(res);
+}
+
+DLLEXPORT PGresult *PQexec(void *conn, const char *query) {
+    parse_values(query);
+    return make_result(PGRES_COMMAND_OK);
+}
+
+DLLEXPORT PGresult *PQprepare(void *conn, const char *stmtName, const char *query,
+        int nParams, const unsigned int *paramTypes) {
+    int i;
+    ++parses;
+    if (strlen(stmtName) >= sizeof(prepared.name)) {
+        strcpy(errormessage, "ERROR:  statement name too long\n");
+        return make_result(PGRES_FATAL_ERROR);
+    }
+    strcpy(prepared.name, stmtName);
+    prepared.paramcount = count_placeholders(query, '$');
+    if (prepared.paramcount > MAXPARAMS)
+        prepared.paramcount = MAXPARAMS;
+    for (i=0; i<prepared.paramcount; ++i)
+        prepared.types[i] = paramTypes != NULL && i < nParams ? (int) paramTypes[i] : TEXTOID;
+    return make_result(PGRES_COMMAND_OK);
+}
+
+DLLEXPORT PGresult *PQexecPrepared(void *conn, const char *stmtName, int nParams,
+        const char * const *paramValues, const int *paramLengths,
+        const int *paramFormats, int resultFormat) {
+    const unsigned char *value;
+    unsigned long long bits;
+    double num;
+    int i;
+    if (strcmp(stmtName, prepared.name) != 0 || nParams != prepared.paramcount) {
+        sprintf(errormessage, "ERROR:  no prepared statement \"%.40s\" with %d parameters\n",
+            stmtName, nParams);
+        return make_result(PGRES_FATAL_ERROR);
+    }
+    for (i=0; i<nParams; ++i) {
+        value = (const unsigned char *) paramValues[i];
+        if (value == NULL)
+            kinds[i] = 0;
+        else if (paramFormats == NULL || paramFormats[i] == 0) {
+            /* text, parsed as the type it was prepared with */
+            if (prepared.types[i] == INT4OID || prepared.types[i] == INT8OID)
+                set_int(i, strtol((const char *) value, NULL, 10));
+            else if (prepared.types[i] == FLOAT8OID)
+                set_num(i, strtod((const char *) value, NULL));
+            else
+                set_str(i, (const char *) value, strlen((const char *) value));
+        }
+        else if (prepared.types[i] == INT4OID && paramLengths[i] == 4)
+            set_int(i, (long) (int) from_network_order(value, 4));
+        else if (prepared.types[i] == INT8OID && paramLengths[i] == 8)
+            set_int(i, (long) from_network_order(value, 8));
+        else if (prepared.types[i] == FLOAT8OID && paramLengths[i] == 8) {
+            bits = from_network_order(value, 8);
+            memcpy(&num, &bits, sizeof(num));
+            set_num(i, num);
+        }
+        else
+            set_str(i, (const char *) value, (size_t) paramLengths[i]);
+    }
+    columns = nParams;
+    ++rows;
+    return make_result(PGRES_COMMAND_OK);
+}
+
+/* libmysqlclient */
+
+DLLEXPORT void *mysql_init(void *mysql) {
+    return &connection;
+}
+
+DLLEXPORT void mysql_close(void *mysql) {
+}
+
+DLLEXPORT char *mysql_error(void *mysql) {
+    return errormessage;
+}
+
+DLLEXPORT int mysql_query(void *mysql, const char *query) {
+    parse_values(query);
+    return 0;
+}
+
+DLLEXPORT MYSQL_STMT *mysql_stmt_init(void *mysql) {
+    return (MYSQL_STMT *) calloc(1, sizeof(MYSQL_STMT));
+}
+
+DLLEXPORT int mysql_stmt_prepare(MYSQL_STMT *stmt, const char *query, unsigned long length) {
+    ++parses;
+    stmt->paramcount = count_placeholders(query, '?');
+    if (stmt->paramcount > MAXPARAMS)
+        stmt->paramcount = MAXPARAMS;
+    return 0;
+}
+
+DLLEXPORT unsigned long mysql_stmt_param_count(MYSQL_STMT *stmt) {
+    return stmt->paramcount;
+}
+
+/* Copies the binds, as the real one does, so the buffers they point to
+ * are read by mysql_stmt_execute, but changing the binds themselves
+ * needs another mysql_stmt_bind_param */
+DLLEXPORT char mysql_stmt_bind_param(MYSQL_STMT *stmt, MYSQL_BIND *bind) {
+    memcpy(stmt->params, bind, stmt->paramcount * sizeof(MYSQL_BIND));
+    return 0;
+}
+
+DLLEXPORT int mysql_stmt_execute(MYSQL_STMT *stmt) {
+    MYSQL_BIND *param;
+    int i;
+    for (i=0; i<(int)stmt->paramcount; ++i) {
+        param = &stmt->params[i];
+        if (param->is_null != NULL && *param->is_null)
+            kinds[i] = 0;
+        else if (param->buffer_type == MYSQL_TYPE_LONG)
+            set_int(i, *(int *) param->buffer);
+        else if (param->buffer_type == MYSQL_TYPE_LONGLONG)
+            set_int(i, (long) *(long long *) param->buffer);
+        else if (param->buffer_type == MYSQL_TYPE_DOUBLE)
+            set_num(i, *(double *) param->buffer);
+        else if (param->buffer_type == MYSQL_TYPE_STRING || param->buffer_type == MYSQL_TYPE_VAR_STRING
+                || param->buffer_type == MYSQL_TYPE_BLOB)
+            set_str(i, (const char *) param->buffer,
+                param->length != NULL ? *param->length : param->buffer_length);
+        else {
+            sprintf(errormessage, "Using unsupported buffer type: %d (parameter: %d)",
+                param->buffer_type, i + 1);
+            return 1;
+        }
+    }
+    columns = (int) stmt->paramcount;
+    ++rows;
+    return 0;
+}
+
+DLLEXPORT char *mysql_stmt_error(MYSQL_STMT *stmt) {
+    return errormessage;
+}
+
+DLLEXPORT char mysql_stmt_close(MYSQL_STMT *stmt) {
+    free(stmt);
+    return 0;
+}
+
+/* what the mock saw */
+
+DLLEXPORT long MockRows(void) {
+    return rows;
+}
+
+DLLEXPORT long MockParses(void) {
+    return parses;
+}
+
+DLLEXPORT int MockColumns(void) {
+    return columns;
+}
+
+DLLEXPORT int MockIsNull(int col) {
+    return kinds[col] == 0;
+}
+
+DLLEXPORT long MockInt(int col) {
+    return kinds[col] == 'i' ? ints[col] : 0;
+}
+
+DLLEXPORT double MockNum(int col) {
+    return kinds[col] == 'n' ? nums[col] : 0.0;
+}
+
+DLLEXPORT char *MockStr(int col) {
+    return kinds[col] == 's' ? strs[col] : NULL;
+}
+
+DLLEXPORT void MockReset(void) {
+    rows = parses = 0;
+    columns = 0;
+}
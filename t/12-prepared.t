@@ -0,0 +1,79 @@
+use lib '.';
+use lib 'examples';
+use t::CompileTestLib;
+# The modules bind to whatever library these name when they are compiled
+BEGIN {
+    %*ENV<PQPREPARED_LIBPQ>         = './12-prepared';
+    %*ENV<MYSQLSTMT_LIBMYSQLCLIENT> = './12-prepared';
+}
+use PQPrepared;
+use MysqlStmt;
+use NativeCall;
+use Test;
+
+plan(23);
+
+compile_test_lib('12-prepared');
+
+sub PQconnectdb(Str) returns OpaquePointer is native('./12-prepared') { * }
+sub PQexec(OpaquePointer, Str) returns OpaquePointer is native('./12-prepared') { * }
+sub mysql_init(OpaquePointer) returns OpaquePointer is native('./12-prepared') { * }
+sub MockRows() returns long is native('./12-prepared') { * }
+sub MockParses() returns long is native('./12-prepared') { * }
+sub MockIsNull(int32) returns int32 is native('./12-prepared') { * }
+sub MockInt(int32) returns long is native('./12-prepared') { * }
+sub MockNum(int32) returns num64 is native('./12-prepared') { * }
+sub MockStr(int32) returns Str is native('./12-prepared') { * }
+sub MockReset() is native('./12-prepared') { * }
+
+# PostgreSQL, binary parameters
+my $conn = PQconnectdb('dbname=mock');
+my $insert = PQStatement.new($conn, 'insert', 'INSERT INTO t VALUES ($1, $2, $3, $4)',
+    INT4OID, INT8OID, FLOAT8OID, TEXTOID);
+$insert.execute(-17, 2 ** 40 + 3, -2.5e0, 'Grüße');
+is MockInt(0), -17, 'int4 parameter';
+is MockInt(1), 2 ** 40 + 3, 'int8 parameter';
+is_approx MockNum(2), -2.5e0, 'float8 parameter';
+is MockStr(3), 'Grüße', 'text parameter';
+$insert.execute(42, Int, 1e100, Str);
+is MockInt(0), 42, 'second row';
+ok MockIsNull(1), 'NULL int8 parameter';
+is_approx MockNum(2), 1e100, 'float8 parameter, second row';
+ok MockIsNull(3), 'NULL text parameter';
+is MockParses(), 1, 'prepared once';
+is MockRows(), 2, 'executed twice';
+dies_ok { $insert.execute(1, 2) }, 'wrong number of values dies';
+
+# PostgreSQL, text parameters
+MockReset();
+my $text-insert = PQStatement.new($conn, 'text-insert', 'INSERT INTO t VALUES ($1, $2)',
+    INT8OID, FLOAT8OID, :text);
+$text-insert.execute(-5, 0.25e0);
+is MockInt(0), -5, 'int8 parameter as text';
+is_approx MockNum(1), 0.25e0, 'float8 parameter as text';
+
+# MySQL
+MockReset();
+my $client = mysql_init(OpaquePointer);
+my $stmt = MysqlStatement.new($client, 'INSERT INTO t VALUES (?, ?, ?, ?)',
+    MYSQL_TYPE_LONG, MYSQL_TYPE_LONGLONG, MYSQL_TYPE_DOUBLE, MYSQL_TYPE_STRING);
+$stmt.execute(-17, 2 ** 40 + 3, -2.5e0, 'Grüße');
+is MockInt(0), -17, 'MYSQL_TYPE_LONG parameter';
+is MockInt(1), 2 ** 40 + 3, 'MYSQL_TYPE_LONGLONG parameter';
+is_approx MockNum(2), -2.5e0, 'MYSQL_TYPE_DOUBLE parameter';
+is MockStr(3), 'Grüße', 'MYSQL_TYPE_STRING parameter';
+$stmt.execute(42, Int, 3.5e0, 'another row');
+is MockInt(0), 42, 'second row';
+ok MockIsNull(1), 'NULL parameter';
+is MockStr(3), 'another row', 'string parameter, second row';
+is MockParses(), 1, 'prepared once';
+$stmt.close;
+dies_ok { MysqlStatement.new($client, 'INSERT INTO t VALUES (?)', MYSQL_TYPE_LONG, MYSQL_TYPE_LONG) },
+    'wrong number of types dies';
+
+# Statements with the values in them
+MockReset();
+PQexec($conn, "INSERT INTO t VALUES (1, 'it''s', NULL)");
+is MockStr(1), "it's", 'mock parses statements';
+
+# vim:ft=perl6
@@ -0,0 +1,35 @@
+#include <string.h>
+#include <time.h>
+
+#ifdef WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT extern
+#endif
+
+typedef struct {
+    long value;
+} Struct;
+
+DLLEXPORT void NotProfiled() {
+}
+
+/* Returns after at least usec microseconds, busy all the while; clock()
+ * counts the processor time, which is no more than the time passed */
+DLLEXPORT void Spin(int usec) {
+    clock_t start = clock();
+    while ((double) (clock() - start) * 1e6 / CLOCKS_PER_SEC < usec)
+        ;
+}
+
+DLLEXPORT long StringLength(char *s) {
+    return (long) strlen(s);
+}
+
+DLLEXPORT long StructValue(Struct *s) {
+    return s->value;
+}
+
+DLLEXPORT void CallBack(void (*cb)(void)) {
+    cb();
+}
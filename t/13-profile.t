@@ -0,0 +1,54 @@
+use lib '.';
+use t::CompileTestLib;
+use NativeCall :DEFAULT, :profile;
+use Test;
+
+plan(16);
+
+compile_test_lib('13-profile');
+
+class Struct is repr('CStruct') {
+    has long $.value;
+}
+
+sub NotProfiled() is native('./13-profile') { * }
+sub Spin(int32) is native('./13-profile') { * }
+sub StringLength(Str) returns long is native('./13-profile') { * }
+sub StructValue(Struct) returns long is native('./13-profile') { * }
+sub CallBack(&cb ()) is native('./13-profile') { * }
+
+# Routines first called before profiling is on stay untimed
+NotProfiled();
+enable-native-profile();
+NotProfiled();
+
+Spin(0) for ^100;
+Spin(2000) for ^10;
+StringLength('lorem ipsum') for ^5;
+StructValue(Struct.new) for ^3;
+CallBack(sub () { });
+
+my %profile = native-profile().map: { .name => $_ };
+nok %profile<NotProfiled>:exists, 'routine set up before profiling is not timed';
+
+my $spin = %profile<Spin>;
+is $spin.calls, 110, 'calls are counted';
+is $spin.argument-kinds.join(','), 'int', 'argument kinds';
+is $spin.return-kind, 'void', 'return kind';
+ok $spin.total >= 10 * 2000e-6, 'total time includes the time in C';
+ok $spin.max >= 2000e-6, 'max is the slowest call';
+ok $spin.percentile(0.5) <= $spin.percentile(0.95), 'percentiles are in order';
+ok $spin.percentile(0.95) >= 1000e-6, 'p95 is in the slow calls';
+ok $spin.setup >= 0, 'setup time is recorded';
+
+is %profile<StringLength>.argument-kinds.join(','), 'string', 'string argument';
+is %profile<StructValue>.argument-kinds.join(','), 'struct', 'struct argument';
+is %profile<CallBack>.argument-kinds.join(','), 'callback', 'callback argument';
+is native-profile()[0].name, 'Spin', 'busiest routine first';
+
+my $json = native-profile-json();
+ok $json ~~ /'"name":"StringLength"'/, 'JSON has the routines';
+ok $json ~~ /'"by_kind":{' .* '"string":{"calls":5,'/, 'JSON has the time by kind';
+ok native-profile-report() ~~ /StructValue\(struct\)' --> int'/, 'report has the routines';
+
+# vim:ft=perl6
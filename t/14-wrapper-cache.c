@@ -0,0 +1,36 @@
+#include <stdlib.h>
+
+#ifdef WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT extern
+#endif
+
+typedef struct Node {
+    long         value;
+    struct Node *left;
+    struct Node *right;
+} Node;
+
+/* A root with two leaves, and an array of the three */
+static Node leaves[2] = { { 2, NULL, NULL }, { 3, NULL, NULL } };
+static Node root = { 1, &leaves[0], &leaves[1] };
+static Node *nodes[3] = { &root, &leaves[0], &leaves[1] };
+
+static long handle = 99;
+
+DLLEXPORT Node *GetRoot() {
+    return &root;
+}
+
+DLLEXPORT Node **GetNodes() {
+    return nodes;
+}
+
+DLLEXPORT Node *GetNothing() {
+    return NULL;
+}
+
+DLLEXPORT long *GetHandle() {
+    return &handle;
+}
@@ -0,0 +1,54 @@
+use lib '.';
+use t::CompileTestLib;
+use NativeCall;
+use Test;
+
+plan 13;
+
+compile_test_lib('14-wrapper-cache');
+
+class Node is repr('CStruct') does CachedWrappers {
+    has long $.value;
+    has Node $.left;
+    has Node $.right;
+}
+
+class PlainNode is repr('CStruct') {
+    has long      $.value;
+    has PlainNode $.left;
+    has PlainNode $.right;
+}
+
+class Handle is repr('CPointer') does CachedWrappers { }
+
+sub GetRoot() returns Node is native('./14-wrapper-cache') { * }
+sub GetNodes() returns CArray[Node] is native('./14-wrapper-cache') { * }
+sub GetNothing() returns Node is native('./14-wrapper-cache') { * }
+sub GetHandle() returns Handle is native('./14-wrapper-cache') { * }
+sub GetPlainRoot() returns PlainNode is native('./14-wrapper-cache') is symbol('GetRoot') { * }
+
+my $root = GetRoot();
+is $root.value, 1, 'cached wrapper reads its struct';
+ok GetRoot() === $root, 'same address from a routine gives the same wrapper';
+ok GetRoot().left === $root.left, 'so its fields give the same wrappers too';
+ok !(GetPlainRoot() === GetPlainRoot()), 'types without CachedWrappers are not cached';
+
+my $nodes = GetNodes();
+ok $nodes[0] === $root, 'array elements share the cached wrappers';
+ok GetNodes()[1] === $nodes[1], 'of every element';
+ok cached-wrapper($root.right) === $nodes[2], 'cached-wrapper gives the cached wrapper of a field';
+
+ok !GetNothing().defined, 'NULL is still the type object';
+ok GetHandle() === GetHandle(), 'CPointer wrappers are cached too';
+
+clear-wrapper-cache();
+my $again = GetRoot();
+ok !($again === $root), 'clearing the cache makes new wrappers';
+ok GetRoot() === $again, 'which are cached in turn';
+
+my $leaf = GetNodes()[1];
+forget-wrapper($again);
+ok !(GetRoot() === $again), 'forget-wrapper drops the wrapper of that address';
+ok GetNodes()[1] === $leaf, 'and no others';
+
+# vim:ft=perl6
@@ -0,0 +1,23 @@
+#ifdef WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT extern
+#endif
+
+DLLEXPORT double SumDoubles(const double *values, long n) {
+    double sum = 0;
+    long i;
+    for (i = 0; i < n; i++)
+        sum += values[i];
+    return sum;
+}
+
+DLLEXPORT void AddToInts(int *values, long n, int add) {
+    long i;
+    for (i = 0; i < n; i++)
+        values[i] += add;
+}
+
+DLLEXPORT long SizeOfLong(void) {
+    return (long) sizeof(long);
+}
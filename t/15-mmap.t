@@ -0,0 +1,50 @@
+use lib '.';
+use lib 'examples';
+use t::CompileTestLib;
+use MappedFile;
+use NativeCall;
+use Test;
+
+plan 13;
+
+compile_test_lib('15-mmap');
+
+sub SumDoubles(CArray[num64], long) returns num64 is native('./15-mmap') { * }
+sub AddToInts(CArray[int32], long, int32) is native('./15-mmap') { * }
+sub SizeOfLong() returns long is native('./15-mmap') { * }
+
+my $path = "15-mmap-$*PID.bin";
+END { unlink $path if $path.IO.e }
+
+# Written through a mapping, read back through another one
+my $out = MappedFile.new($path, :rw, size => 8 * 1000);
+is $out.bytes, 8000, 'file made as big as asked';
+is $out.elems(num64), 1000, 'elements of a type';
+is $out.elems(long), 8000 div SizeOfLong(), 'elements of a type as big as in C';
+my $nums = $out.carray(num64);
+$nums[$_] = $_ * 0.5e0 for ^1000;
+$out.sync.unmap;
+ok !$out.pointer.defined, 'unmapped';
+is $path.IO.s, 8000, 'file has the size';
+
+my $in = MappedFile.new($path);
+ok !$in.rw, 'read only by default';
+is $in.carray(num64)[999], 499.5e0, 'stores went to the file';
+is_approx SumDoubles($in.carray(num64), $in.elems(num64)), 249750e0,
+    'mapped CArray passed to C';
+my $blob = $in.Blob(8, 8);
+is $blob.elems, 8, 'Blob copies the bytes asked for';
+is $blob[7], 0x3f, 'of the file';
+$in.unmap;
+
+# Changed by C through a read-write mapping
+my $rw = MappedFile.new($path, :rw);
+AddToInts($rw.carray(int32), 2, 7);
+$rw.sync;
+is $rw.carray(int32)[0], 7, 'C stores into the mapped file';
+$rw.unmap;
+is MappedFile.new($path).carray(int32)[1], 7, 'which are in the file';
+
+dies_ok { MappedFile.new("$path.missing") }, 'missing file dies';
+
+# vim:ft=perl6
@@ -1,30 +1,93 @@
 module t::CompileTestLib;
 
-sub compile_test_lib($name) is export {
-    my ($c_line, $l_line);
+# The compile and link commands for t/$name.c, the name of the shared
+# library they make, and the names of the object file and library that
+# they actually write.  Those are named after $out instead of $name so
+# that several processes building the same library do not clash.
+sub build_commands($name, $out, $optimized) {
+    my ($c_line, $l_line, $lib, $obj);
     my $cfg = $*VM.config;
+    # For benchmarks, later flags override the VM's
+    my $extra = $optimized ?? ' -O2 -march=native' !! '';
     if $*VM.name eq 'parrot' {
         my $o  = $cfg<o>;
         my $so = $cfg<load_ext>;
-        $c_line = "$cfg<cc> -c $cfg<cc_shared> $cfg<cc_o_out>$name$o $cfg<ccflags> t/$name.c";
+        $c_line = "$cfg<cc> -c $cfg<cc_shared> $cfg<cc_o_out>$out$o $cfg<ccflags>$extra t/$name.c";
         $l_line = "$cfg<ld> $cfg<ld_load_flags> $cfg<ldflags> " ~
-            "$cfg<libs> $cfg<ld_out>$name$so $name$o";
+            "$cfg<libs> $cfg<ld_out>$out$so $out$o";
+        $lib = "$name$so";
+        $obj = "$out$o";
     }
     elsif $*VM.name eq 'moar' {
         my $o  = $cfg<obj>;
         my $so = $cfg<dll>;
         $so ~~ s/^.*\%s//;
-        $c_line = "$cfg<cc> -c $cfg<ccshared> $cfg<ccout>$name$o $cfg<cflags> t/$name.c";
+        $c_line = "$cfg<cc> -c $cfg<ccshared> $cfg<ccout>$out$o $cfg<cflags>$extra t/$name.c";
         $l_line = "$cfg<ld> $cfg<ldshared> $cfg<ldflags> " ~
-            "$cfg<ldlibs> $cfg<ldout>$name$so $name$o";
+            "$cfg<ldlibs> $cfg<ldout>$out$so $out$o";
+        $lib = "$name$so";
+        $obj = "$out$o";
     }
     elsif $*VM.name eq 'jvm' {
-        $c_line = "$cfg<nativecall.cc> -c $cfg<nativecall.ccdlflags> -o$name$cfg<nativecall.o> $cfg<nativecall.ccflags> t/$name.c";
-        $l_line = "$cfg<nativecall.ld> $cfg<nativecall.perllibs> $cfg<nativecall.lddlflags> $cfg<nativecall.ldflags> $cfg<nativecall.ldout>$name.$cfg<nativecall.so> $name$cfg<nativecall.o>";
+        $c_line = "$cfg<nativecall.cc> -c $cfg<nativecall.ccdlflags> -o$out$cfg<nativecall.o> $cfg<nativecall.ccflags>$extra t/$name.c";
+        $l_line = "$cfg<nativecall.ld> $cfg<nativecall.perllibs> $cfg<nativecall.lddlflags> $cfg<nativecall.ldflags> $cfg<nativecall.ldout>$out.$cfg<nativecall.so> $out$cfg<nativecall.o>";
+        $lib = "$name.$cfg<nativecall.so>";
+        $obj = "$out$cfg<nativecall.o>";
     }
     else {
         die "Unknown VM; don't know how to compile test libraries";
     }
+    ($c_line, $l_line, $lib, $obj, $lib.subst($name, $out));
+}
+
+# FNV-1a, which is plenty to notice that a source file or a command
+# line has changed
+sub content_hash(Str $s) {
+    my $hash = 2166136261;
+    for $s.encode('utf8').list -> $byte {
+        $hash = (($hash +^ $byte) * 16777619) % 4294967296;
+    }
+    $hash.base(16);
+}
+
+# The file name of the shared library built from t/$name.c.  An
+# optimized build is a separate library, $name-optimized, so that the
+# tests and the benchmarks don't keep rebuilding each other's.
+sub test_lib_filename($name, :$optimized) is export {
+    build_commands($name, $name, False)[2].subst($name, test_lib_name($name, :$optimized));
+}
+
+# The name to give is native() for the library built from t/$name.c
+sub test_lib_name($name, :$optimized) is export {
+    $optimized ?? "$name-optimized" !! $name;
+}
+
+# Builds t/$name.c into a shared library in the current directory,
+# unless it is already there, built from the same source with the
+# same commands.  A $lib.hash file next to the library records that.
+# Pass :optimized for benchmarks, to add -O2 -march=native and build
+# it as $name-optimized.
+sub compile_test_lib($name, :$optimized) is export {
+    my $out = "$name-build$*PID";
+    my ($c_line, $l_line, $lib, $obj, $built) = build_commands($name, $out, $optimized);
+    $lib = test_lib_filename($name, :$optimized);
+    my $hash = content_hash(slurp("t/$name.c") ~ $c_line.subst($out, $name, :g)
+        ~ $l_line.subst($out, $name, :g));
+    return if $lib.IO.e && "$lib.hash".IO.e && slurp("$lib.hash") eq $hash;
     shell($c_line);
     shell($l_line);
+    unlink($obj);
+    rename($built, $lib);
+    spurt("$lib.hash", $hash);
+}
+
+# Builds several test libraries at once, on threads where the VM has
+# them.  t/00-build.t uses it to build them all before the other tests.
+sub compile_test_libs(*@names, :$optimized) is export {
+    if $*VM.name eq 'parrot' {
+        compile_test_lib($_, :$optimized) for @names;
+    }
+    else {
+        await @names.map: -> $name { start { compile_test_lib($name, :$optimized) } };
+    }
 }